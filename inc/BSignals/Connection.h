@@ -0,0 +1,107 @@
+/*
+ * File:   Connection.h
+ * Handles referring directly to a connected slot.
+ * Disconnecting through a handle needs no lookup, and handles that outlive
+ * their slot (or its signal) are harmless.
+ */
+
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+namespace BSignals{
+
+namespace details{
+
+//Part of every connected slot that handles can see
+class SlotLink{
+public:
+    //Set once disconnected, the remaining bits count active blockers
+    static const uint32_t disconnectedBit = 0x80000000u;
+
+    SlotLink(uint32_t slotId) : id(slotId) {}
+    virtual ~SlotLink() = default;
+
+    //Checked on emission, zero unless blocked or disconnected
+    inline bool isActive() const {
+        return state.load(std::memory_order_relaxed) == 0;
+    }
+
+    inline bool isConnected() const {
+        return !(state.load(std::memory_order_acquire) & disconnectedBit);
+    }
+
+    //Disconnects through the owning signal
+    virtual void disconnect() = 0;
+
+    std::atomic<uint32_t> state{0};
+    const uint32_t id;
+
+private:
+    SlotLink(const SlotLink&) = delete;
+    void operator=(const SlotLink&) = delete;
+};
+}
+
+class Connection{
+public:
+    Connection() = default;
+
+    explicit Connection(std::weak_ptr<BSignals::details::SlotLink> slotLink);
+
+    //Disconnects the slot if it is still connected, waiting for queued emissions
+    void disconnect() const;
+
+    bool connected() const;
+
+    //Id usable with disconnectSlot, -1 once the slot is gone
+    int id() const;
+
+private:
+    friend class ConnectionBlocker;
+    std::weak_ptr<BSignals::details::SlotLink> link;
+};
+
+//Disconnects the slot when it goes out of scope
+class ScopedConnection : public Connection{
+public:
+    ScopedConnection() = default;
+
+    ScopedConnection(Connection &&connection);
+
+    ScopedConnection(ScopedConnection &&that) = default;
+
+    ScopedConnection &operator=(ScopedConnection &&that);
+
+    ~ScopedConnection();
+
+    //Gives up ownership, the slot stays connected
+    Connection release();
+
+private:
+    ScopedConnection(const ScopedConnection&) = delete;
+    void operator=(const ScopedConnection&) = delete;
+};
+
+//Suppresses emission to the slot for its lifetime, blockers nest
+class ConnectionBlocker{
+public:
+    explicit ConnectionBlocker(const Connection &connection);
+
+    ConnectionBlocker(ConnectionBlocker &&that) = default;
+
+    ~ConnectionBlocker();
+
+private:
+    std::shared_ptr<BSignals::details::SlotLink> link;
+
+    ConnectionBlocker(const ConnectionBlocker&) = delete;
+    void operator=(const ConnectionBlocker&) = delete;
+};
+
+}
+
+#endif /* CONNECTION_H */
@@ -10,6 +10,7 @@
 #define SIGNAL_HPP
 
 #include "BSignals/details/SignalImpl.hpp"
+#include "BSignals/ThreadPool.h"
 
 namespace BSignals{
 
@@ -19,6 +20,56 @@ enum class ExecutorScheme{
     STRAND,
     THREAD_POOLED
 };
+
+//What a bounded strand slot does with an emission that finds its queue full
+enum class OverflowPolicy{
+    BLOCK,          //emission waits for room
+    DROP_NEWEST,    //the new emission is discarded
+    DROP_OLDEST,    //the oldest queued emission is discarded to make room
+    FAIL_FAST       //the new emission is discarded and emitSignal returns false
+};
+
+//Queue bound for a strand slot, capacity is rounded up to a power of two
+//singleProducer declares that the slot's signal is never emitted from two
+//threads at once, the strand then queues through a wait-free SPSC ring.
+//It needs a non-zero capacity and can't be combined with DROP_OLDEST, the
+//connect functions throw std::invalid_argument on either. Debug builds
+//assert on a second producer
+struct QueueLimit{
+    uint32_t capacity;
+    OverflowPolicy policy;
+    bool singleProducer{false};
+};
+
+//Enqueued and dequeued counts, current depth and high watermark of a queue
+typedef BSignals::details::QueueStats QueueStats;
+
+//Sets the number of global thread pool threads, 0 restores the default. Only takes
+//effect before the first thread pooled slot is connected, returns false after
+inline bool configureThreadPool(uint32_t threads){
+    return BSignals::details::WheeledThreadPool::global().configure(threads);
+}
+
+//Can be changed at any time, the default is LEAST_LOADED_OF_TWO
+inline void setThreadPoolSelection(SpokeSelection selection){
+    BSignals::details::WheeledThreadPool::global().setSpokeSelection((BSignals::details::SpokeSelection)selection);
+}
+
+//Makes the global thread pool elastic, it grows from minThreads up to maxThreads
+//while emissions find every thread busy, and retires threads left idle for
+//idleTimeout. Only takes effect before the first thread pooled slot is
+//connected, returns false after or if the bounds are invalid
+inline bool configureThreadPool(uint32_t minThreads, uint32_t maxThreads, 
+        std::chrono::steady_clock::duration idleTimeout = std::chrono::seconds(1)){
+    return BSignals::details::WheeledThreadPool::global().configure(minThreads, maxThreads, idleTimeout);
+}
+
+//Threads the global pool runs with (or will start with). By default this is the
+//BSIGNALS_POOL_THREADS environment variable if set, otherwise the number of
+//CPUs the process may use, capped by its cgroup CPU quota
+inline uint32_t threadPoolSize(){
+    return BSignals::details::WheeledThreadPool::global().getPoolSize();
+}
     
 template <typename... Args>
 class Signal{
@@ -36,25 +87,127 @@ public:
     
     ~Signal(){}
 
+    //Slots with a higher priority are invoked (or queued) first, slots of
+    //equal priority in order of connection, regardless of executor
+    //Move only arguments cannot be shared between slots, such a signal takes
+    //one slot at a time and throws std::logic_error on connecting a second
+    template<typename F, typename C>
+    int connectMemberSlot(const ExecutorScheme &scheme, F&& function, C&& instance, int32_t priority = 0) const {
+        return signalImpl.connectMemberSlot((BSignals::details::ExecutorScheme)scheme, std::forward<F>(function), std::forward<C>(instance), priority);
+    }
+    
+    template<typename F>
+    int connectSlot(const ExecutorScheme &scheme, F&& slot, int32_t priority = 0) const {
+        return signalImpl.connectSlot((BSignals::details::ExecutorScheme)scheme, std::forward<F>(slot), priority);
+    }
+    
+    //Handle based connection, the handle disconnects without any lookup and
+    //can block emission to the slot through a ConnectionBlocker
+    template<typename F, typename C>
+    Connection connectMember(const ExecutorScheme &scheme, F&& function, C&& instance, int32_t priority = 0) const {
+        return Connection(signalImpl.connectMember((BSignals::details::ExecutorScheme)scheme, std::forward<F>(function), std::forward<C>(instance), priority));
+    }
+    
+    template<typename F>
+    Connection connect(const ExecutorScheme &scheme, F&& slot, int32_t priority = 0) const {
+        return Connection(signalImpl.connect((BSignals::details::ExecutorScheme)scheme, std::forward<F>(slot), priority));
+    }
+    
+    //Thread pooled slots run by the given pool rather than the global one
+    //The pool must outlive the connection
+    template<typename F, typename C>
+    int connectMemberSlot(ThreadPool &pool, F&& function, C&& instance, int32_t priority = 0) const {
+        return signalImpl.connectMemberSlot(pool.pool, std::forward<F>(function), std::forward<C>(instance), priority);
+    }
+    
+    template<typename F>
+    int connectSlot(ThreadPool &pool, F&& slot, int32_t priority = 0) const {
+        return signalImpl.connectSlot(pool.pool, std::forward<F>(slot), priority);
+    }
+    
+    template<typename F, typename C>
+    Connection connectMember(ThreadPool &pool, F&& function, C&& instance, int32_t priority = 0) const {
+        return Connection(signalImpl.connectMember(pool.pool, std::forward<F>(function), std::forward<C>(instance), priority));
+    }
+    
+    template<typename F>
+    Connection connect(ThreadPool &pool, F&& slot, int32_t priority = 0) const {
+        return Connection(signalImpl.connect(pool.pool, std::forward<F>(slot), priority));
+    }
+    
+    //Bounds the queue of a strand slot, other executors have no queue of
+    //their own and ignore the limit
     template<typename F, typename C>
-    int connectMemberSlot(const ExecutorScheme &scheme, F&& function, C&& instance) const {
-        return signalImpl.connectMemberSlot((BSignals::details::ExecutorScheme)scheme, std::forward<F>(function), std::forward<C>(instance));
+    int connectMemberSlot(const ExecutorScheme &scheme, F&& function, C&& instance, const QueueLimit &limit, int32_t priority = 0) const {
+        return signalImpl.connectMemberSlot((BSignals::details::ExecutorScheme)scheme, std::forward<F>(function), std::forward<C>(instance), 
+            priority, limit.capacity, (BSignals::details::OverflowPolicy)limit.policy, limit.singleProducer);
     }
     
-    int connectSlot(const ExecutorScheme &scheme, std::function<void(Args...)> slot) const {
-        return signalImpl.connectSlot((BSignals::details::ExecutorScheme)scheme, slot);
+    template<typename F>
+    int connectSlot(const ExecutorScheme &scheme, F&& slot, const QueueLimit &limit, int32_t priority = 0) const {
+        return signalImpl.connectSlot((BSignals::details::ExecutorScheme)scheme, std::forward<F>(slot), 
+            priority, limit.capacity, (BSignals::details::OverflowPolicy)limit.policy, limit.singleProducer);
     }
     
+    template<typename F, typename C>
+    Connection connectMember(const ExecutorScheme &scheme, F&& function, C&& instance, const QueueLimit &limit, int32_t priority = 0) const {
+        return Connection(signalImpl.connectMember((BSignals::details::ExecutorScheme)scheme, std::forward<F>(function), std::forward<C>(instance), 
+            priority, limit.capacity, (BSignals::details::OverflowPolicy)limit.policy, limit.singleProducer));
+    }
+    
+    template<typename F>
+    Connection connect(const ExecutorScheme &scheme, F&& slot, const QueueLimit &limit, int32_t priority = 0) const {
+        return Connection(signalImpl.connect((BSignals::details::ExecutorScheme)scheme, std::forward<F>(slot), 
+            priority, limit.capacity, (BSignals::details::OverflowPolicy)limit.policy, limit.singleProducer));
+    }
+    
+    //Waits for the slot's queued work and running threads, but not for other
+    //slots. A slot disconnecting itself must use disconnectSlotAsync
     void disconnectSlot(const uint32_t &id) const {
         signalImpl.disconnectSlot(id);
     }
     
+    //Returns without waiting for the slot's queued work to drain
+    //Wait on the returned future if the slot must no longer be running
+    std::shared_future<void> disconnectSlotAsync(const uint32_t &id) const {
+        return signalImpl.disconnectSlotAsync(id);
+    }
+    
     void disconnectAllSlots() const { 
         signalImpl.disconnectAllSlots();
     }
     
-    void emitSignal(const Args &... p) const {
-        signalImpl.emitSignal(p...);
+    //Queue counters of every connected strand slot, keyed by slot id
+    std::map<uint32_t, QueueStats> queueStats() const {
+        return signalImpl.queueStats();
+    }
+    
+    //Queue counters of each global thread pool spoke
+    static std::vector<QueueStats> threadPoolStats(){
+        return BSignals::details::WheeledThreadPool::global().queueStats();
+    }
+    
+    //Returns false if a FAIL_FAST strand slot had no room for the emission
+    bool emitSignal(typename BSignals::details::Param<Args>::type... p) const {
+        return signalImpl.emitSignal(p...);
+    }
+    
+    //Moves rather than copies into the final connected slot
+    template <bool B = !BSignals::details::AllPassByValue<Args...>::value, typename = typename std::enable_if<B>::type>
+    bool emitSignal(typename BSignals::details::ForwardParam<Args>::type... p) const {
+        return signalImpl.emitSignal(std::forward<typename BSignals::details::ForwardParam<Args>::type>(p)...);
+    }
+    
+    //Emits a burst of elements, each the argument (or a tuple of the arguments)
+    //for one emission. Queued slots receive the whole burst in one operation
+    template <typename InputIt>
+    bool emitSignalBatch(InputIt first, InputIt last) const {
+        return signalImpl.emitSignalBatch(first, last);
+    }
+    
+    template <typename E>
+    bool emitSignalBatch(const E *batch, std::size_t count) const {
+        return signalImpl.emitSignalBatch(batch, count);
     }
     
 private:
@@ -0,0 +1,73 @@
+/* 
+ * File:   StaticSignal.hpp
+ * Signal whose executor is chosen at compile time
+ * The slots themselves are still called through a type erased function
+ */
+
+#ifndef STATICSIGNAL_HPP
+#define STATICSIGNAL_HPP
+
+#include "BSignals/Signal.hpp"
+#include "BSignals/details/StaticSignalImpl.hpp"
+
+namespace BSignals{
+
+template <ExecutorScheme scheme, typename... Args>
+class StaticSignal{
+public:
+    StaticSignal() = default;
+    
+    StaticSignal(bool enforceThreadSafety) 
+        : signalImpl(enforceThreadSafety){}
+    
+    //Only available for ASYNCHRONOUS signals
+    StaticSignal(uint32_t maxAsyncThreads) 
+        : signalImpl(maxAsyncThreads) {}
+    
+    //Only available for ASYNCHRONOUS signals
+    StaticSignal(bool enforceThreadSafety, uint32_t maxAsyncThreads) 
+        : signalImpl(enforceThreadSafety, maxAsyncThreads) {}
+    
+    ~StaticSignal(){}
+
+    //Throws std::logic_error on connecting a second slot to a signal with move
+    //only arguments, they cannot be shared between slots
+    template<typename F, typename C>
+    int connectMemberSlot(F&& function, C&& instance) const {
+        return signalImpl.connectMemberSlot(std::forward<F>(function), std::forward<C>(instance));
+    }
+    
+    template<typename F>
+    int connectSlot(F&& slot) const {
+        return signalImpl.connectSlot(std::forward<F>(slot));
+    }
+    
+    void disconnectSlot(const uint32_t &id) const {
+        signalImpl.disconnectSlot(id);
+    }
+    
+    void disconnectAllSlots() const { 
+        signalImpl.disconnectAllSlots();
+    }
+    
+    //Takes the arguments as Signal does, and likewise returns false if a
+    //strand slot rejected the emission
+    bool emitSignal(typename BSignals::details::Param<Args>::type... p) const {
+        return signalImpl.emitSignal(p...);
+    }
+    
+    //Moves rather than copies into the final connected slot
+    template <bool B = !BSignals::details::AllPassByValue<Args...>::value, typename = typename std::enable_if<B>::type>
+    bool emitSignal(typename BSignals::details::ForwardParam<Args>::type... p) const {
+        return signalImpl.emitSignal(std::forward<typename BSignals::details::ForwardParam<Args>::type>(p)...);
+    }
+    
+private:
+    BSignals::details::StaticSignalImpl<(BSignals::details::ExecutorScheme)scheme, Args...> signalImpl;
+    StaticSignal(const StaticSignal& that) = delete;
+    void operator=(const StaticSignal&) = delete;
+};
+
+} /* namespace BSignals */
+
+#endif /* STATICSIGNAL_HPP */
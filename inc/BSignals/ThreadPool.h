@@ -0,0 +1,67 @@
+/*
+ * File:   ThreadPool.h
+ * Thread pools that thread pooled slots can be connected to.
+ * A slot connected to a pool of its own is isolated from the global pool and
+ * from every other pool, a slow or noisy subsystem only holds up its own.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "BSignals/details/WheeledThreadPool.h"
+
+namespace BSignals{
+
+template <typename... Args>
+class Signal;
+
+//How emissions to thread pooled slots pick a pool thread to queue on
+enum class SpokeSelection{
+    ROUND_ROBIN,            //each thread in turn
+    LEAST_LOADED_OF_TWO     //the less loaded of two threads sampled at random
+};
+
+class ThreadPool{
+public:
+    //A pool of a fixed number of threads, 0 for the default size (see
+    //threadPoolSize)
+    explicit ThreadPool(uint32_t threads = 0, SpokeSelection selection = SpokeSelection::LEAST_LOADED_OF_TWO);
+
+    //An elastic pool, it grows from minThreads up to maxThreads while
+    //emissions find every thread busy, and retires threads left idle for
+    //idleTimeout. minThreads is raised to 1 and maxThreads to minThreads
+    ThreadPool(uint32_t minThreads, uint32_t maxThreads,
+        std::chrono::steady_clock::duration idleTimeout = std::chrono::seconds(1),
+        SpokeSelection selection = SpokeSelection::LEAST_LOADED_OF_TWO);
+
+    //Stops the threads, emissions still queued are discarded. Slots connected
+    //to the pool must be disconnected first, disconnectSlotAsync is enough as
+    //their discarded emissions are released too
+    ~ThreadPool();
+
+    //Threads the pool runs with, or will start with. The threads are started
+    //when the first slot is connected
+    uint32_t size() const;
+
+    //Can be changed at any time
+    void setSelection(SpokeSelection selection);
+
+    //Queue counters of each of the pool's threads
+    std::vector<BSignals::details::QueueStats> stats() const;
+
+private:
+    template <typename... Args>
+    friend class Signal;
+    BSignals::details::WheeledThreadPool pool;
+
+    ThreadPool(const ThreadPool&) = delete;
+    void operator=(const ThreadPool&) = delete;
+};
+
+}
+
+#endif /* THREADPOOL_H */
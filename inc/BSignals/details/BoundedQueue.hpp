@@ -0,0 +1,225 @@
+/*
+ * File:   BoundedQueue.hpp
+ * Bounded lock free multi-producer multi-consumer ring
+ * Based on Dmitry Vyukov's bounded MPMC queue
+ * http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ * Each cell carries a sequence number telling producers and consumers whose
+ * turn it is, so claiming a cell is a single CAS on the enqueue or dequeue
+ * position. Cells are padded to a cache line so that neighbouring producers
+ * and the consumer don't contend on the same line.
+ * Capacity is rounded up to a power of two. Blocked readers and writers park
+ * on event counts, the sequence accesses they check are seq_cst for that reason.
+ */
+
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "BSignals/details/CacheLine.h"
+#include "BSignals/details/EventCount.h"
+#include "BSignals/details/QueueStats.h"
+
+namespace BSignals{ namespace details{
+
+template <typename T>
+class BoundedQueue{
+public:
+    explicit BoundedQueue(uint32_t minCapacity)
+        : mask(roundUp(minCapacity) - 1) {
+        std::size_t size = mask + 1;
+        storage = ::operator new(size*sizeof(Cell) + cacheLineSize);
+        void *aligned = storage;
+        std::size_t space = size*sizeof(Cell) + cacheLineSize;
+        cells = static_cast<Cell*>(std::align(cacheLineSize, size*sizeof(Cell), aligned, space));
+        for (std::size_t i=0; i<size; ++i){
+            new (&cells[i]) Cell(i);
+        }
+    }
+
+    ~BoundedQueue(){
+        T output;
+        while (dequeue(output)) {}
+        for (std::size_t i=0; i<=mask; ++i){
+            cells[i].~Cell();
+        }
+        ::operator delete(storage);
+    }
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+    //The positions double as the enqueued and dequeued counts
+    QueueStats stats() const {
+        uint64_t dequeued = dequeuePos.load(std::memory_order_seq_cst);
+        return makeQueueStats(enqueuePos.load(std::memory_order_seq_cst), dequeued, 
+            highWatermark.load(std::memory_order_relaxed));
+    }
+
+    //Fails without touching input if the ring is full
+    bool tryEnqueue(T &&input){
+        std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;){
+            cell = &cells[pos & mask];
+            std::size_t seq = cell->sequence.load(std::memory_order_seq_cst);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0){
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0){
+                return false;
+            }
+            else{
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(input);
+        cell->sequence.store(pos + 1, std::memory_order_seq_cst);
+        raiseWatermark(highWatermark, pos + 1, dequeuePos.load(std::memory_order_relaxed));
+        readerEvent.notify();
+        return true;
+    }
+
+    //Waits for room while keepWaiting() holds, returns false if it gave up
+    template <typename Predicate>
+    bool blockingEnqueue(T &&input, Predicate keepWaiting){
+        while (!tryEnqueue(std::move(input))){
+            EventCount::Key key = writerEvent.prepareWait();
+            if (tryEnqueue(std::move(input))) return true;
+            if (!keepWaiting()) return false;
+            writerEvent.wait(key);
+        }
+        return true;
+    }
+
+    bool dequeue(T &output){
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;){
+            cell = &cells[pos & mask];
+            std::size_t seq = cell->sequence.load(std::memory_order_seq_cst);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0){
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0){
+                return false;
+            }
+            else{
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        output = std::move(cell->data);
+        cell->sequence.store(pos + mask + 1, std::memory_order_seq_cst);
+        writerEvent.notify();
+        return true;
+    }
+
+    //Claims up to max filled cells with a single CAS, returns how many were written
+    template <typename OutputIt>
+    std::size_t dequeueBulk(OutputIt output, std::size_t max){
+        return consumeRun(max, [&output](T &&item){ *output++ = std::move(item); });
+    }
+    
+    //Claims every filled cell with a single CAS and hands each element to
+    //consume in FIFO order, returns how many were consumed
+    template <typename F>
+    std::size_t consumeAll(F &&consume){
+        return consumeRun(mask + 1, consume);
+    }
+    
+    void blockingDequeue(T &output){
+        while (!dequeue(output)){
+            EventCount::Key key = readerEvent.prepareWait();
+            if (empty()) readerEvent.wait(key);
+        }
+    }
+    
+    //Returns false if nothing arrived before the deadline
+    bool blockingDequeueUntil(T &output, std::chrono::steady_clock::time_point deadline){
+        while (!dequeue(output)){
+            EventCount::Key key = readerEvent.prepareWait();
+            if (empty() && !readerEvent.waitUntil(key, deadline)) return dequeue(output);
+        }
+        return true;
+    }
+    
+    template <typename Rep, typename Period>
+    bool blockingDequeueFor(T &output, const std::chrono::duration<Rep, Period> &timeout){
+        return blockingDequeueUntil(output, std::chrono::steady_clock::now() + 
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+    }
+
+private:
+    struct alignas(cacheLineSize) Cell{
+        explicit Cell(std::size_t seq) : sequence(seq) {}
+
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    template <typename F>
+    std::size_t consumeRun(std::size_t max, F &&consume){
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        std::size_t count;
+        for (;;){
+            count = 0;
+            while (count < max && cells[(pos + count) & mask].sequence.load(std::memory_order_seq_cst) == pos + count + 1){
+                ++count;
+            }
+            if (count == 0) return 0;
+            if (dequeuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) break;
+        }
+        //each cell is released before its element is consumed, so that
+        //blocked writers make progress while the run is processed
+        for (std::size_t i=0; i<count; ++i){
+            Cell &cell = cells[(pos + i) & mask];
+            T item = std::move(cell.data);
+            cell.sequence.store(pos + i + mask + 1, std::memory_order_seq_cst);
+            writerEvent.notify();
+            consume(std::move(item));
+        }
+        return count;
+    }
+    
+    static std::size_t roundUp(uint32_t n){
+        std::size_t size = 2;
+        while (size < n) size <<= 1;
+        return size;
+    }
+
+    //True until the cell at the dequeue position has been filled
+    bool empty() const {
+        std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        return cells[pos & mask].sequence.load(std::memory_order_seq_cst) == pos;
+    }
+
+    //the positions are padded rather than aligned so that the queue itself
+    //needs no over-aligned allocation
+    const std::size_t mask;
+    void *storage;
+    Cell *cells;
+    char headPad[cacheLineSize];
+    std::atomic<std::size_t> enqueuePos{0};
+    char enqueuePad[cacheLineSize - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> dequeuePos{0};
+    char dequeuePad[cacheLineSize - sizeof(std::atomic<std::size_t>)];
+    std::atomic<uint64_t> highWatermark{0};
+    EventCount readerEvent;
+    EventCount writerEvent;
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    void operator=(const BoundedQueue&) = delete;
+};
+
+}}
+
+#endif /* BOUNDEDQUEUE_HPP */
@@ -0,0 +1,20 @@
+/*
+ * File:   CacheLine.h
+ * Cache line size used to keep independently written state apart
+ * Hot members are separated by whole lines of padding rather than aligned,
+ * so that their isolation doesn't depend on over-aligned allocation, which
+ * operator new doesn't honour before C++17.
+ */
+
+#ifndef CACHELINE_H
+#define CACHELINE_H
+
+#include <cstddef>
+
+namespace BSignals{ namespace details{
+
+static const std::size_t cacheLineSize = 64;
+
+}}
+
+#endif /* CACHELINE_H */
@@ -0,0 +1,96 @@
+/* 
+ * File:   EpochReclaimer.h
+ * Epoch based reclamation for objects read without a lock
+ * Readers announce the global epoch they entered in a per-thread record,
+ * writers unlink an object, tag it with the current epoch and only free it
+ * once no active reader can have entered at or before that epoch.
+ * Protected pointers must be loaded with memory_order_seq_cst inside the
+ * read section.
+ */
+
+#ifndef EPOCHRECLAIMER_H
+#define EPOCHRECLAIMER_H
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+namespace BSignals{ namespace details{
+
+class EpochReclaimer{
+public:
+    //Read side critical section, may be nested
+    class ReadGuard{
+    public:
+        ReadGuard(){ EpochReclaimer::enter(); }
+        ~ReadGuard(){ EpochReclaimer::exit(); }
+        ReadGuard(const ReadGuard&) = delete;
+        void operator=(const ReadGuard&) = delete;
+    };
+    
+    static inline void enter(){
+        ReaderState &state = readerState;
+        if (state.nesting++ == 0){
+            if (state.record == nullptr) state.record = registerReader();
+            //seq_cst so that a reader's later seq_cst loads of protected pointers
+            //are ordered after its announcement
+            state.record->epoch.exchange(globalEpoch.load(std::memory_order_acquire), std::memory_order_seq_cst);
+        }
+    }
+    
+    static inline void exit(){
+        ReaderState &state = readerState;
+        if (--state.nesting == 0){
+            state.record->epoch.store(0, std::memory_order_release);
+        }
+    }
+    
+    EpochReclaimer() = default;
+    ~EpochReclaimer();
+    
+    //Retire an object that has already been unlinked from shared view
+    //Retire and reclaim are not thread safe, callers serialise writes
+    template <typename T>
+    void retire(T *ptr){
+        retired.push_back({advanceEpoch(), ptr, [](void *p){ delete static_cast<T*>(p); }});
+    }
+    
+    //Free every retired object that no reader can still observe
+    void reclaim();
+    
+private:
+    struct ReaderRecord{
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> inUse{true};
+        ReaderRecord *next{nullptr};
+        //keep each reader's announcements on its own cache line
+        char padding[64];
+    };
+    
+    struct ReaderState{
+        ReaderRecord *record;
+        uint32_t nesting;
+    };
+    
+    struct Retired{
+        uint64_t epoch;
+        void *ptr;
+        void (*deleter)(void*);
+    };
+    
+    static ReaderRecord *registerReader();
+    static uint64_t advanceEpoch();
+    static uint64_t oldestActiveEpoch();
+    
+    static std::atomic<uint64_t> globalEpoch;
+    static std::atomic<ReaderRecord*> readers;
+    static thread_local ReaderState readerState;
+    
+    std::vector<Retired> retired;
+    
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    void operator=(const EpochReclaimer&) = delete;
+};
+}}
+
+#endif /* EPOCHRECLAIMER_H */
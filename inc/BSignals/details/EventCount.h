@@ -0,0 +1,71 @@
+/*
+ * File:   EventCount.h
+ * Lets a consumer park until producers signal, without producers taking a lock
+ * A waiter registers with prepareWait, rechecks its condition and only then
+ * waits on the returned key. Producers publish first and then call notify,
+ * which is a single load unless someone has registered since the last
+ * notification. Both sides must order their condition accesses with
+ * memory_order_seq_cst (or a seq_cst RMW) for the handshake to be race free.
+ * The low bit of the state marks registered waiters, the rest is an epoch
+ * that notification advances. The first notifier to see the bit clears it
+ * and wakes, so a parked waiter costs producers one wakeup.
+ * Parks on a futex on Linux, otherwise on a mutex and condition variable.
+ * Timed waits take an absolute steady clock deadline, on Linux the futex
+ * waits on CLOCK_MONOTONIC with that deadline so retries never drift.
+ */
+
+#ifndef EVENTCOUNT_H
+#define EVENTCOUNT_H
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+
+#ifndef LINUX
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace BSignals{ namespace details{
+
+class EventCount{
+public:
+    typedef uint32_t Key;
+
+    EventCount() = default;
+
+    //Registers the caller as a waiter, the condition must be rechecked
+    //before waiting. Not waiting after all needs no cleanup
+    Key prepareWait();
+
+    //Blocks until notified after the key was taken
+    void wait(Key key);
+    
+    //As wait, but gives up at the deadline. Returns false if it timed out
+    //without being notified
+    bool waitUntil(Key key, std::chrono::steady_clock::time_point deadline);
+
+    inline void notify(){
+        if (state.load(std::memory_order_seq_cst) & waitingBit){
+            notifyWaiters();
+        }
+    }
+
+private:
+    void notifyWaiters();
+
+    static const uint32_t waitingBit = 1;
+
+    std::atomic<uint32_t> state{0};
+#ifndef LINUX
+    std::mutex mutex;
+    std::condition_variable cv;
+#endif
+
+    EventCount(const EventCount&) = delete;
+    void operator=(const EventCount&) = delete;
+};
+
+}}
+
+#endif /* EVENTCOUNT_H */
@@ -0,0 +1,105 @@
+/*
+ * File:   InFlightCount.h
+ * Counts the asynchronous and thread pooled tasks of one slot that have not
+ * finished yet, so that disconnecting the slot can wait for them without
+ * holding up its signal or the other slots.
+ * A task holds a Token for as long as it exists, a discarded task releases it
+ * too. Closing stops further tokens from being issued, the returned future is
+ * ready once every issued token has been released.
+ * The count and the closed bit share one word, so exactly one thread (the
+ * closer or the last releaser) sees the count reach zero after closing, and
+ * nothing touches the counter after that.
+ */
+
+#ifndef INFLIGHTCOUNT_H
+#define INFLIGHTCOUNT_H
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <utility>
+
+namespace BSignals{ namespace details{
+
+class InFlightCount{
+public:
+    InFlightCount();
+
+    //Released when destroyed, moved from tokens hold nothing
+    class Token{
+    public:
+        Token() = default;
+
+        Token(Token &&that) noexcept : count(that.count){
+            that.count = nullptr;
+        }
+
+        ~Token(){
+            if (count) count->release();
+        }
+
+        explicit operator bool() const {
+            return count != nullptr;
+        }
+
+    private:
+        friend class InFlightCount;
+        explicit Token(InFlightCount *c) : count(c) {}
+        InFlightCount *count{nullptr};
+
+        Token(const Token&) = delete;
+        void operator=(const Token&) = delete;
+    };
+
+    //An empty token once closed, the task must then not be queued
+    inline Token tryAcquire(){
+        uint32_t state = count.load(std::memory_order_relaxed);
+        do{
+            if (state & closedBit) return Token();
+        } while (!count.compare_exchange_weak(state, state + 1,
+            std::memory_order_relaxed, std::memory_order_relaxed));
+        return Token(this);
+    }
+
+    //Idempotent, the future is ready once every issued token is released
+    std::shared_future<void> close();
+
+    bool isDrained() const;
+
+private:
+    static const uint32_t closedBit = 0x80000000u;
+
+    inline void release(){
+        if (count.fetch_sub(1, std::memory_order_acq_rel) == (closedBit | 1)) finish();
+    }
+
+    void finish();
+
+    std::atomic<uint32_t> count{0};
+    std::promise<void> drained;
+    std::shared_future<void> drainedFuture;
+
+    InFlightCount(const InFlightCount&) = delete;
+    void operator=(const InFlightCount&) = delete;
+};
+
+//A task that holds a token, members are destroyed in reverse order so the
+//task (and whatever it has bound) is gone before the token is released
+template <typename F>
+struct CountedTask{
+    InFlightCount::Token token;
+    F task;
+
+    void operator()(){
+        task();
+    }
+};
+
+template <typename F>
+inline CountedTask<typename std::decay<F>::type> countedTask(InFlightCount::Token &&token, F &&task){
+    return CountedTask<typename std::decay<F>::type>{std::move(token), std::forward<F>(task)};
+}
+
+}}
+
+#endif /* INFLIGHTCOUNT_H */
@@ -31,6 +31,15 @@
  * This is an adaptation of https://github.com/mstump/queues/blob/master/include/mpsc-queue.hpp
  * The queue has been modified such that it can also be used as a blocking queue
  * Aligned storage was removed, was causing segmentation faults and didn't improve performance
+ * Nodes come from a default constructible allocator rebound to the node type,
+ * by default the lock free node pool, rather than new/delete per element
+ * A blocked reader parks on an event count, producers only pay a load to
+ * check for it
+ * Depth and throughput are counted with relaxed atomics, see QueueStats
+ * The head and tail ends are kept on separate cache lines with padding
+ * The library itself queues through TaskQueue, this queue is no longer used
+ * internally and is only kept as a general purpose utility. New queue
+ * features belong in TaskQueue
  * Created on 14 June 2016, 1:14 AM
  */
 
@@ -39,20 +48,26 @@
 #define MPSCQUEUE_HPP
 
 #include <atomic>
-#include <shared_mutex>
-#include <condition_variable>
+#include <cstddef>
 #include <chrono>
 #include <thread>
+#include <utility>
+#include <memory>
 #include <assert.h>
 
+#include "BSignals/details/ObjectPool.hpp"
+#include "BSignals/details/CacheLine.h"
+#include "BSignals/details/EventCount.h"
+#include "BSignals/details/QueueStats.h"
+
 namespace BSignals{ namespace details{
 
-template<typename T>
+template<typename T, typename Allocator = PoolAllocator<T>>
 class MPSCQueue{
 public:
 
     MPSCQueue() :
-        _head(new buffer_node_t),
+        _head(newNode()),
         _tail(_head.load(std::memory_order_relaxed)){
         buffer_node_t* front = _head.load(std::memory_order_relaxed);
         front->next.store(nullptr, std::memory_order_relaxed);
@@ -62,21 +77,34 @@ public:
         T output;
         while (this->dequeue(output)) {}
         buffer_node_t* front = _head.load(std::memory_order_relaxed);
-        delete front;
+        deleteNode(front);
     }
     
     void enqueue(const T& input){
-        buffer_node_t* node = (new buffer_node_t);
-        node->data = input;
-        node->next.store(nullptr, std::memory_order_relaxed);
-
-        buffer_node_t* prev_head = _head.exchange(node, std::memory_order_acq_rel);
-        prev_head->next.store(node, std::memory_order_release);
+        push(newNode(input));
+    }
+    
+    void enqueue(T&& input){
+        push(newNode(std::move(input)));
+    }
+    
+    //Constructs the element in place in its node
+    template <typename... A>
+    void emplace(A&&... args){
+        push(newNode(std::forward<A>(args)...));
+    }
 
-        std::shared_lock<std::shared_timed_mutex> lock(_mutex);        
-        if (waitingReader){
-            _cv.notify_one();   
-        }
+    class Chain;
+    
+    //Links every node of the chain with a single exchange and one wakeup
+    void enqueue(Chain &&chain){
+        if (chain.first == nullptr) return;
+        countEnqueued(chain.count);
+        buffer_node_t* prev_head = _head.exchange(chain.last, std::memory_order_seq_cst);
+        prev_head->next.store(chain.first, std::memory_order_release);
+        chain.first = chain.last = nullptr;
+        chain.count = 0;
+        _readerEvent.notify();
     }
 
     bool dequeue(T& output){
@@ -87,36 +115,208 @@ public:
             return false;
         }
 
-        output = next->data;
+        output = std::move(next->data);
         _tail.store(next, std::memory_order_release);
-        delete tail;
+        deleteNode(tail);
+        countDequeued(1);
         return true;
     }
     
+    //Moves up to max elements out, the tail is published once for the run
+    template <typename OutputIt>
+    std::size_t dequeueBulk(OutputIt output, std::size_t max){
+        buffer_node_t* tail = _tail.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+        while (count < max){
+            buffer_node_t* next = tail->next.load(std::memory_order_acquire);
+            if (next == nullptr) break;
+            *output++ = std::move(next->data);
+            deleteNode(tail);
+            tail = next;
+            ++count;
+        }
+        _tail.store(tail, std::memory_order_release);
+        countDequeued(count);
+        return count;
+    }
+    
+    //Claims everything enqueued up to the current head in one load and hands
+    //each element to consume in FIFO order, returns how many were consumed
+    template <typename F>
+    std::size_t consumeAll(F &&consume){
+        buffer_node_t* tail = _tail.load(std::memory_order_relaxed);
+        buffer_node_t* last = _head.load(std::memory_order_acquire);
+        std::size_t count = 0;
+        while (tail != last){
+            buffer_node_t* next;
+            //a producer is between its exchange and its link
+            while ((next = tail->next.load(std::memory_order_acquire)) == nullptr){
+                std::this_thread::yield();
+            }
+            consume(std::move(next->data));
+            deleteNode(tail);
+            tail = next;
+            ++count;
+        }
+        _tail.store(tail, std::memory_order_release);
+        countDequeued(count);
+        return count;
+    }
+    
     void blockingDequeue(T& output){
-        std::shared_lock<std::shared_timed_mutex> lock(_mutex);
-        waitingReader = true;
         while (!dequeue(output)){
-            _cv.wait(_mutex);
+            EventCount::Key key = _readerEvent.prepareWait();
+            if (_head.load(std::memory_order_seq_cst) != _tail.load(std::memory_order_relaxed)){
+                //a producer has swapped the head but not linked its node yet
+                std::this_thread::yield();
+            }
+            else{
+                _readerEvent.wait(key);
+            }
+        }
+    }
+    
+    //Returns false if nothing arrived before the deadline
+    bool blockingDequeueUntil(T& output, std::chrono::steady_clock::time_point deadline){
+        while (!dequeue(output)){
+            EventCount::Key key = _readerEvent.prepareWait();
+            if (_head.load(std::memory_order_seq_cst) != _tail.load(std::memory_order_relaxed)){
+                //a producer has swapped the head but not linked its node yet
+                std::this_thread::yield();
+            }
+            else if (!_readerEvent.waitUntil(key, deadline)){
+                return dequeue(output);
+            }
         }
-        waitingReader = false;
+        return true;
+    }
+    
+    template <typename Rep, typename Period>
+    bool blockingDequeueFor(T& output, const std::chrono::duration<Rep, Period> &timeout){
+        return blockingDequeueUntil(output, std::chrono::steady_clock::now() + 
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+    }
+    
+    //Safe to call from any thread
+    QueueStats stats() const {
+        uint64_t dequeued = _dequeued.load(std::memory_order_seq_cst);
+        return makeQueueStats(_enqueued.load(std::memory_order_seq_cst), dequeued, 
+            _highWatermark.load(std::memory_order_relaxed));
     }
     
 private:
 
     struct buffer_node_t{
+        template <typename... A>
+        explicit buffer_node_t(A&&... args) 
+            : data(std::forward<A>(args)...), next(nullptr) {}
+        
         T                           data;
         std::atomic<buffer_node_t*> next;
     };
+    
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<buffer_node_t> NodeAllocator;
+    typedef std::allocator_traits<NodeAllocator> NodeTraits;
+    
+    template <typename... A>
+    static buffer_node_t* newNode(A&&... args){
+        NodeAllocator allocator;
+        buffer_node_t* node = NodeTraits::allocate(allocator, 1);
+        try{
+            NodeTraits::construct(allocator, node, std::forward<A>(args)...);
+        }
+        catch (...){
+            NodeTraits::deallocate(allocator, node, 1);
+            throw;
+        }
+        return node;
+    }
+    
+    static void deleteNode(buffer_node_t* node){
+        NodeAllocator allocator;
+        NodeTraits::destroy(allocator, node);
+        NodeTraits::deallocate(allocator, node, 1);
+    }
+    
+    void countEnqueued(uint64_t n){
+        uint64_t enqueued = _enqueued.fetch_add(n, std::memory_order_relaxed) + n;
+        raiseWatermark(_highWatermark, enqueued, _dequeued.load(std::memory_order_relaxed));
+    }
+    
+    //consumer only, so a plain load and store suffice
+    void countDequeued(uint64_t n){
+        _dequeued.store(_dequeued.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    
+    void push(buffer_node_t* node){
+        countEnqueued(1);
+        //seq_cst so that the exchange is ordered before the waiter check
+        buffer_node_t* prev_head = _head.exchange(node, std::memory_order_seq_cst);
+        prev_head->next.store(node, std::memory_order_release);
+        _readerEvent.notify();
+    }
 
+    //producers write the head line and only read the event count, the
+    //consumer owns the tail line
+    char                        _headPad[cacheLineSize];
     std::atomic<buffer_node_t*> _head;
+    std::atomic<uint64_t>       _enqueued{0};
+    std::atomic<uint64_t>       _highWatermark{0};
+    EventCount                  _readerEvent;
+    char                        _tailPad[cacheLineSize];
     std::atomic<buffer_node_t*> _tail;
-    std::shared_timed_mutex _mutex;
-    std::condition_variable_any _cv;
-    bool waitingReader{false};
+    std::atomic<uint64_t>       _dequeued{0};
+    char                        _endPad[cacheLineSize];
     
     MPSCQueue(const MPSCQueue&) {}
     void operator=(const MPSCQueue&) {}
+    
+public:
+    //Nodes linked privately by one producer, then published to a queue in one go
+    class Chain{
+    public:
+        Chain() = default;
+        
+        Chain(Chain &&that) noexcept : first(that.first), last(that.last), count(that.count){
+            that.first = that.last = nullptr;
+            that.count = 0;
+        }
+        
+        ~Chain(){
+            while (first){
+                buffer_node_t *next = first->next.load(std::memory_order_relaxed);
+                deleteNode(first);
+                first = next;
+            }
+        }
+        
+        void push(T&& input){
+            emplace(std::move(input));
+        }
+        
+        template <typename... A>
+        void emplace(A&&... args){
+            buffer_node_t* node = newNode(std::forward<A>(args)...);
+            if (last) last->next.store(node, std::memory_order_relaxed);
+            else first = node;
+            last = node;
+            ++count;
+        }
+        
+        bool empty() const {
+            return first == nullptr;
+        }
+
+        
+    private:
+        friend class MPSCQueue;
+        buffer_node_t *first{nullptr};
+        buffer_node_t *last{nullptr};
+        uint64_t count{0};
+        
+        Chain(const Chain&) = delete;
+        void operator=(const Chain&) = delete;
+    };
 };
 }}
 
@@ -0,0 +1,146 @@
+/*
+ * File:   ObjectPool.hpp
+ * Lock free, per type pool of fixed size blocks.
+ * Each thread allocates from and frees into its own cache. Blocks freed on
+ * a thread other than the one that allocated them (the usual producer ->
+ * consumer pattern) build up in the freeing thread's cache and are handed
+ * back in batches through a shared free list, which allocating threads take
+ * in one exchange when their own cache runs dry.
+ * Pushing a chain and taking the whole list are both ABA safe.
+ * Strand and thread pooled tasks (makeTask) and shared emission payloads
+ * are drawn from it. PoolAllocator exposes the pool to allocator aware
+ * containers.
+ */
+
+#ifndef OBJECTPOOL_HPP
+#define OBJECTPOOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace BSignals{ namespace details{
+
+template <typename T, std::size_t BatchSize = 64>
+class ObjectPool{
+public:
+    template <typename... A>
+    static T *create(A&&... args){
+        void *block = allocate();
+        try{
+            return new (block) T(std::forward<A>(args)...);
+        }
+        catch (...){
+            deallocate(block);
+            throw;
+        }
+    }
+
+    static void destroy(T *object){
+        object->~T();
+        deallocate(object);
+    }
+
+    static void *allocate(){
+        Cache &cache = localCache;
+        if (cache.head == nullptr){
+            //take everything other threads have handed back
+            cache.head = shared.exchange(nullptr, std::memory_order_acquire);
+            cache.count = 0;
+            for (FreeBlock *b = cache.head; b; b = b->next) ++cache.count;
+            if (cache.head == nullptr){
+                return ::operator new(blockSize);
+            }
+        }
+        FreeBlock *block = cache.head;
+        cache.head = block->next;
+        --cache.count;
+        return block;
+    }
+
+    static void deallocate(void *p){
+        Cache &cache = localCache;
+        FreeBlock *block = static_cast<FreeBlock*>(p);
+        block->next = cache.head;
+        cache.head = block;
+        if (++cache.count >= 2*BatchSize){
+            cache.returnBatch(BatchSize);
+        }
+    }
+
+private:
+    struct FreeBlock{
+        FreeBlock *next;
+    };
+
+    struct Cache{
+        FreeBlock *head{nullptr};
+        std::size_t count{0};
+
+        //hand n blocks back to the shared list as a single chain
+        void returnBatch(std::size_t n){
+            FreeBlock *first = head;
+            FreeBlock *last = head;
+            for (std::size_t i=1; i<n && last->next; ++i) last = last->next;
+            head = last->next;
+            for (FreeBlock *b = first; b != head; b = b->next) --count;
+            FreeBlock *top = shared.load(std::memory_order_relaxed);
+            do {
+                last->next = top;
+            } while (!shared.compare_exchange_weak(top, first, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        ~Cache(){
+            if (head) returnBatch(count);
+        }
+    };
+
+    static const std::size_t blockSize = sizeof(T) > sizeof(FreeBlock) ? sizeof(T) : sizeof(FreeBlock);
+
+    static std::atomic<FreeBlock*> shared;
+    static thread_local Cache localCache;
+};
+
+template <typename T, std::size_t BatchSize>
+std::atomic<typename ObjectPool<T, BatchSize>::FreeBlock*> ObjectPool<T, BatchSize>::shared{nullptr};
+
+template <typename T, std::size_t BatchSize>
+thread_local typename ObjectPool<T, BatchSize>::Cache ObjectPool<T, BatchSize>::localCache;
+
+//Stateless allocator handing out single objects from the ObjectPool
+//Array allocations go straight to the heap
+template <typename T>
+class PoolAllocator{
+public:
+    typedef T value_type;
+
+    PoolAllocator() noexcept = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T *allocate(std::size_t n){
+        if (n == 1) return static_cast<T*>(ObjectPool<T>::allocate());
+        return static_cast<T*>(::operator new(n*sizeof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        if (n == 1) ObjectPool<T>::deallocate(p);
+        else ::operator delete(p);
+    }
+};
+
+template <typename T, typename U>
+inline bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+    return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) noexcept {
+    return false;
+}
+
+}}
+
+#endif /* OBJECTPOOL_HPP */
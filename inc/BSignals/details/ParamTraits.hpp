@@ -0,0 +1,110 @@
+/*
+ * File:   ParamTraits.hpp
+ * Parameter passing traits for emission
+ * Small trivially copyable arguments are passed by value, everything else
+ * by const reference (lvalue emission) or rvalue reference (rvalue emission).
+ */
+
+#ifndef PARAMTRAITS_HPP
+#define PARAMTRAITS_HPP
+
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+namespace BSignals{ namespace details{
+
+//True if T is cheaper to copy than to reference
+template <typename T>
+struct IsPassByValue : std::integral_constant<bool,
+    std::is_reference<T>::value ||
+    (std::is_trivially_copyable<T>::value && sizeof(T) <= 2*sizeof(void*))> {};
+
+template <typename... T>
+struct AllPassByValue : std::true_type {};
+
+template <typename T, typename... Rest>
+struct AllPassByValue<T, Rest...> : std::integral_constant<bool,
+    IsPassByValue<T>::value && AllPassByValue<Rest...>::value> {};
+
+//Parameter type for lvalue emission
+template <typename T>
+struct Param{
+    typedef typename std::conditional<IsPassByValue<T>::value, T, const T&>::type type;
+};
+
+//Parameter type for rvalue emission
+template <typename T>
+struct ForwardParam{
+    typedef typename std::conditional<IsPassByValue<T>::value, T, T&&>::type type;
+};
+
+//Parameter type seen by slots. Copyable arguments that are not passed by
+//value are seen by const reference so one emitted value can serve every
+//slot, move only arguments are handed over by value
+template <typename T>
+struct SlotParam{
+    typedef typename std::conditional<IsPassByValue<T>::value || !std::is_copy_constructible<T>::value,
+        T, const T&>::type type;
+};
+
+//True if queued slots of one emission can share a single copy of the arguments
+template <typename... T>
+struct IsShareable : std::true_type {};
+
+template <typename T, typename... Rest>
+struct IsShareable<T, Rest...> : std::integral_constant<bool,
+    std::is_copy_constructible<T>::value && IsShareable<Rest...>::value> {};
+
+//Emitted parameters as stored by queued executors
+template <typename... Args>
+using BoundArgs = std::tuple<typename std::decay<Args>::type...>;
+
+template <typename F, typename Tuple, std::size_t... I>
+inline void invokeMovedImpl(const F &function, Tuple &args, std::index_sequence<I...>){
+    function(std::move(std::get<I>(args))...);
+}
+
+//Invokes function with the bound arguments moved out, the tuple is spent afterwards
+template <typename F, typename... T>
+inline void invokeMoved(const F &function, std::tuple<T...> &args){
+    invokeMovedImpl(function, args, std::index_sequence_for<T...>{});
+}
+
+template <typename F, typename Tuple, std::size_t... I>
+inline void invokeSharedImpl(const F &function, const Tuple &args, std::index_sequence<I...>){
+    function(std::get<I>(args)...);
+}
+
+//Invokes function with the bound arguments as lvalues, the tuple may be shared
+template <typename F, typename... T>
+inline void invokeShared(const F &function, const std::tuple<T...> &args){
+    invokeSharedImpl(function, args, std::index_sequence_for<T...>{});
+}
+
+//Batch emission elements are the argument itself for single argument
+//signals, or a tuple of the arguments otherwise
+template <std::size_t N>
+struct BatchElement{
+    template <typename F, typename E>
+    static void apply(const F &function, const E &element){
+        applyImpl(function, element, std::make_index_sequence<N>{});
+    }
+    
+    template <typename F, typename E, std::size_t... I>
+    static void applyImpl(const F &function, const E &element, std::index_sequence<I...>){
+        function(std::get<I>(element)...);
+    }
+};
+
+template <>
+struct BatchElement<1>{
+    template <typename F, typename E>
+    static void apply(const F &function, const E &element){
+        function(element);
+    }
+};
+
+}}
+
+#endif /* PARAMTRAITS_HPP */
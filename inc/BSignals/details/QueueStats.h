@@ -0,0 +1,52 @@
+/*
+ * File:   QueueStats.h
+ * Counters reported by the task queues
+ * Producers add to the enqueued count, which sits on the cache line they
+ * already own for the enqueue, and the consumer alone updates the dequeued
+ * count. The high watermark is the largest depth a producer has left behind,
+ * it is only written when it rises, so once it has settled producers just
+ * read it and the dequeued count.
+ * The rings count a run as dequeued once it is claimed, the linked queues once
+ * it has been consumed, so the depth may include the run being processed.
+ */
+
+#ifndef QUEUESTATS_H
+#define QUEUESTATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+
+namespace BSignals{ namespace details{
+
+struct QueueStats{
+    uint64_t enqueued{0};
+    uint64_t dequeued{0};
+    uint64_t depth{0};
+    uint64_t highWatermark{0};
+};
+
+//Called by producers with the counts after their enqueue, a depth that is
+//not ahead of the dequeued count (read later) is not a new high
+inline void raiseWatermark(std::atomic<uint64_t> &watermark, uint64_t enqueued, uint64_t dequeued){
+    if (enqueued <= dequeued) return;
+    uint64_t depth = enqueued - dequeued;
+    uint64_t current = watermark.load(std::memory_order_relaxed);
+    while (depth > current && !watermark.compare_exchange_weak(current, depth, 
+            std::memory_order_relaxed, std::memory_order_relaxed)) {}
+}
+
+//The dequeued count must be read before the enqueued count, every element
+//is counted as enqueued before it can be dequeued
+inline QueueStats makeQueueStats(uint64_t enqueued, uint64_t dequeued, uint64_t highWatermark){
+    QueueStats stats;
+    stats.enqueued = std::max(enqueued, dequeued);
+    stats.dequeued = dequeued;
+    stats.depth = stats.enqueued - dequeued;
+    stats.highWatermark = std::max(highWatermark, stats.depth);
+    return stats;
+}
+
+}}
+
+#endif /* QUEUESTATS_H */
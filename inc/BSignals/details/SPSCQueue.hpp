@@ -0,0 +1,202 @@
+/*
+ * File:   SPSCQueue.hpp
+ * Bounded wait-free single-producer single-consumer ring
+ * Each side owns its position and keeps a cached copy of the other's, which
+ * is only reloaded when the ring looks full (or empty), so in the steady
+ * state neither side touches the other's cache line.
+ * Capacity is rounded up to a power of two. Blocked readers and writers park
+ * on event counts, the position stores they check are seq_cst for that reason.
+ * Debug builds assert if a second producer enqueues concurrently.
+ */
+
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <cassert>
+
+#include "BSignals/details/CacheLine.h"
+#include "BSignals/details/EventCount.h"
+#include "BSignals/details/QueueStats.h"
+
+namespace BSignals{ namespace details{
+
+template <typename T>
+class SPSCQueue{
+public:
+    explicit SPSCQueue(uint32_t minCapacity)
+        : mask(roundUp(minCapacity) - 1), slots(new T[mask + 1]) {}
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+    //The positions double as the enqueued and dequeued counts
+    QueueStats stats() const {
+        uint64_t dequeued = readPos.load(std::memory_order_seq_cst);
+        return makeQueueStats(writePos.load(std::memory_order_seq_cst), dequeued, 
+            highWatermark.load(std::memory_order_relaxed));
+    }
+
+    //Fails without touching input if the ring is full
+    inline bool tryEnqueue(T &&input){
+        ProducerCheck check(*this);
+        std::size_t pos = writePos.load(std::memory_order_relaxed);
+        if (pos - cachedReadPos > mask){
+            cachedReadPos = readPos.load(std::memory_order_seq_cst);
+            if (pos - cachedReadPos > mask) return false;
+        }
+        slots[pos & mask] = std::move(input);
+        writePos.store(pos + 1, std::memory_order_seq_cst);
+        raiseWatermark(highWatermark, pos + 1, readPos.load(std::memory_order_relaxed));
+        readerEvent.notify();
+        return true;
+    }
+
+    //Waits for room while keepWaiting() holds, returns false if it gave up
+    template <typename Predicate>
+    bool blockingEnqueue(T &&input, Predicate keepWaiting){
+        while (!tryEnqueue(std::move(input))){
+            EventCount::Key key = writerEvent.prepareWait();
+            if (tryEnqueue(std::move(input))) return true;
+            if (!keepWaiting()) return false;
+            writerEvent.wait(key);
+        }
+        return true;
+    }
+
+    inline bool dequeue(T &output){
+        std::size_t pos = readPos.load(std::memory_order_relaxed);
+        if (pos == cachedWritePos){
+            cachedWritePos = writePos.load(std::memory_order_seq_cst);
+            if (pos == cachedWritePos) return false;
+        }
+        output = std::move(slots[pos & mask]);
+        readPos.store(pos + 1, std::memory_order_seq_cst);
+        writerEvent.notify();
+        return true;
+    }
+
+    //Moves up to max elements out, returns how many were written
+    template <typename OutputIt>
+    std::size_t dequeueBulk(OutputIt output, std::size_t max){
+        return consumeRun(max, [&output](T &&item){ *output++ = std::move(item); });
+    }
+
+    //Hands every element enqueued so far to consume in FIFO order,
+    //returns how many were consumed
+    template <typename F>
+    std::size_t consumeAll(F &&consume){
+        return consumeRun(mask + 1, consume);
+    }
+
+    //Waits for an element while keepWaiting() holds, returns false if it gave up
+    template <typename Predicate>
+    bool blockingDequeue(T &output, Predicate keepWaiting){
+        while (!dequeue(output)){
+            EventCount::Key key = readerEvent.prepareWait();
+            if (dequeue(output)) return true;
+            if (!keepWaiting()) return false;
+            readerEvent.wait(key);
+        }
+        return true;
+    }
+
+    //Returns false if nothing arrived before the deadline
+    bool blockingDequeueUntil(T &output, std::chrono::steady_clock::time_point deadline){
+        return blockingDequeueUntil(output, deadline, [](){ return true; });
+    }
+
+    //Gives up at the deadline or once keepWaiting() no longer holds
+    template <typename Predicate>
+    bool blockingDequeueUntil(T &output, std::chrono::steady_clock::time_point deadline, Predicate keepWaiting){
+        while (!dequeue(output)){
+            EventCount::Key key = readerEvent.prepareWait();
+            if (dequeue(output)) return true;
+            if (!keepWaiting()) return false;
+            if (!readerEvent.waitUntil(key, deadline)) return dequeue(output);
+        }
+        return true;
+    }
+
+    template <typename Rep, typename Period>
+    bool blockingDequeueFor(T &output, const std::chrono::duration<Rep, Period> &timeout){
+        return blockingDequeueUntil(output, std::chrono::steady_clock::now() + 
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+    }
+
+    //Wakes a blocked reader so that it rechecks its predicate
+    void wakeReader(){
+        readerEvent.notify();
+    }
+
+private:
+#ifndef NDEBUG
+    struct ProducerCheck{
+        explicit ProducerCheck(SPSCQueue &q) : queue(q){
+            assert(!queue.producing.exchange(true, std::memory_order_acquire) && "SPSCQueue has a second producer");
+        }
+        ~ProducerCheck(){
+            queue.producing.store(false, std::memory_order_release);
+        }
+        SPSCQueue &queue;
+    };
+#else
+    struct ProducerCheck{
+        explicit ProducerCheck(SPSCQueue&) {}
+    };
+#endif
+
+    template <typename F>
+    std::size_t consumeRun(std::size_t max, F &&consume){
+        std::size_t pos = readPos.load(std::memory_order_relaxed);
+        if (pos == cachedWritePos) cachedWritePos = writePos.load(std::memory_order_seq_cst);
+        std::size_t count = cachedWritePos - pos;
+        if (count > max) count = max;
+        //each slot is released before its element is consumed, so that
+        //a blocked writer makes progress while the run is processed
+        for (std::size_t i=0; i<count; ++i){
+            T item = std::move(slots[(pos + i) & mask]);
+            readPos.store(pos + i + 1, std::memory_order_seq_cst);
+            writerEvent.notify();
+            consume(std::move(item));
+        }
+        return count;
+    }
+
+    static std::size_t roundUp(uint32_t n){
+        std::size_t size = 2;
+        while (size < n) size <<= 1;
+        return size;
+    }
+
+    //the positions are padded rather than aligned so that the queue itself
+    //needs no over-aligned allocation
+    const std::size_t mask;
+    std::unique_ptr<T[]> slots;
+    char headPad[cacheLineSize];
+    std::atomic<std::size_t> writePos{0};
+    std::size_t cachedReadPos{0};
+#ifndef NDEBUG
+    std::atomic<bool> producing{false};
+#endif
+    char writePad[cacheLineSize];
+    std::atomic<std::size_t> readPos{0};
+    std::size_t cachedWritePos{0};
+    char readPad[cacheLineSize];
+    std::atomic<uint64_t> highWatermark{0};
+    EventCount readerEvent;
+    EventCount writerEvent;
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    void operator=(const SPSCQueue&) = delete;
+};
+
+}}
+
+#endif /* SPSCQUEUE_HPP */
@@ -13,6 +13,8 @@
 #include <condition_variable>
 #include <chrono>
 #include <vector>
+#include <utility>
+#include <type_traits>
 
 namespace BSignals{ namespace details{
 template <class T>
@@ -34,14 +36,28 @@ public:
         c.notify_one();
     }
     
+    void enqueue(T &&t){
+        std::lock_guard<std::mutex> lock(m);
+        q.push(std::move(t));
+        c.notify_one();
+    }
+    
+    //Constructs the element in place from args
+    template<typename ...Args>
+    void emplace(Args&& ...args){
+        std::lock_guard<std::mutex> lock(m);
+        q.emplace(std::forward<Args>(args)...);
+        c.notify_one();
+    }
+    
     T dequeue(void){
         std::unique_lock<std::mutex> lock(m);
-        if (terminateFlag) return shutdownObject;
+        if (terminateFlag) return shutdownValue();
         while (q.empty()){
             c.wait(lock);
-            if (terminateFlag) return shutdownObject;
+            if (terminateFlag) return shutdownValue();
         }
-        T val = q.front();
+        T val = std::move(q.front());
         q.pop();
         return val;
     }
@@ -51,14 +67,15 @@ public:
         while (q.empty()){
             c.wait(lock);
             if (terminateFlag){
-                std::vector<T> ret(1);
-                ret[0] = shutdownObject;
+                std::vector<T> ret;
+                ret.push_back(shutdownValue());
                 return ret;
             }
         }
-        std::vector<T> ret(q.size());
-        for (uint32_t i=0; !q.empty(); ++i){
-            ret[i] = q.front();
+        std::vector<T> ret;
+        ret.reserve(q.size());
+        while (!q.empty()){
+            ret.push_back(std::move(q.front()));
             q.pop();
         }
         return ret;
@@ -73,7 +90,7 @@ public:
         }
         bool success = (c.wait_for(lock, timeout) == std::cv_status::no_timeout);
         if (!success) return ret;
-        ret.first = q.front();
+        ret.first = std::move(q.front());
         q.pop();
         ret.second = true;
         return ret;
@@ -83,7 +100,7 @@ public:
         std::unique_lock<std::mutex> lock(m);
         std::pair<T, bool> ret;
         if (!q.empty()){
-            ret.first = q.front();
+            ret.first = std::move(q.front());
             q.pop();
             ret.second = true;
         }
@@ -145,6 +162,20 @@ public:
     }
     
 private:
+    //Move only elements cannot hand out copies of the shutdown object, a
+    //default constructed element stands in for it
+    T shutdownValue() const {
+        return shutdownValue(std::is_copy_constructible<T>());
+    }
+    
+    T shutdownValue(std::true_type) const {
+        return shutdownObject;
+    }
+    
+    T shutdownValue(std::false_type) const {
+        return T();
+    }
+    
     T shutdownObject;
     bool terminateFlag;
     std::queue<T> q;
@@ -0,0 +1,75 @@
+/*
+ * File:   SharedPayload.hpp
+ * Emitted arguments shared by all queued slots of a single emission.
+ * The block is reference counted and drawn from a pool, it is returned when
+ * the last task referencing it has run (or been discarded).
+ */
+
+#ifndef SHAREDPAYLOAD_HPP
+#define SHAREDPAYLOAD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "BSignals/details/ObjectPool.hpp"
+#include "BSignals/details/ParamTraits.hpp"
+
+namespace BSignals{ namespace details{
+
+template <typename... Args>
+class SharedPayload{
+public:
+    typedef BoundArgs<Args...> Tuple;
+
+    //Owning reference, one is handed to each queued task
+    class Ref{
+    public:
+        explicit Ref(SharedPayload *p) noexcept : payload(p) {}
+
+        Ref(Ref &&that) noexcept : payload(that.payload) {
+            that.payload = nullptr;
+        }
+
+        ~Ref(){
+            if (payload) payload->release();
+        }
+
+        const Tuple &args() const noexcept {
+            return payload->args;
+        }
+
+    private:
+        SharedPayload *payload;
+
+        Ref(const Ref&) = delete;
+        void operator=(const Ref&) = delete;
+    };
+
+    //The payload starts with refCount references, the caller must construct
+    //exactly that many Refs from the returned pointer
+    template <typename... P>
+    static SharedPayload *create(uint32_t refCount, P&&... p){
+        return ObjectPool<SharedPayload>::create(refCount, std::forward<P>(p)...);
+    }
+
+    template <typename... P>
+    SharedPayload(uint32_t refCount, P&&... p)
+        : refs{refCount}, args(std::forward<P>(p)...) {}
+
+    //The last reference returns the block, references that were never
+    //handed to a Ref are dropped here in one go
+    void release(uint32_t count = 1) noexcept {
+        if (refs.fetch_sub(count, std::memory_order_acq_rel) == count){
+            ObjectPool<SharedPayload>::destroy(this);
+        }
+    }
+
+private:
+    std::atomic<uint32_t> refs;
+    Tuple args;
+};
+
+}}
+
+#endif /* SHAREDPAYLOAD_HPP */
@@ -9,19 +9,30 @@
 #define SIGNALIMPL_HPP
 
 #include <functional>
-#include <map>
 #include <unordered_map>
+#include <map>
+#include <vector>
+#include <memory>
+#include <algorithm>
 #include <atomic>
 #include <mutex>
-#include <shared_mutex>
 #include <condition_variable>
 #include <thread>
+#include <future>
+#include <stdexcept>
 #include <utility>
 #include <type_traits>
 
-#include "BSignals/details/MPSCQueue.hpp"
+#include "BSignals/details/TaskNode.hpp"
+#include "BSignals/details/UniqueFunction.hpp"
+#include "BSignals/details/ParamTraits.hpp"
+#include "BSignals/details/SharedPayload.hpp"
 #include "BSignals/details/WheeledThreadPool.h"
 #include "BSignals/details/Semaphore.h"
+#include "BSignals/details/InFlightCount.h"
+#include "BSignals/details/Strand.h"
+#include "BSignals/details/EpochReclaimer.h"
+#include "BSignals/Connection.h"
 
 namespace BSignals{ namespace details{
 
@@ -54,9 +65,9 @@ namespace BSignals{ namespace details{
     // THREAD POOLED:
     // Emission occurs asynchronously. 
     // On connection, if it is the first thread pooled function by any signal, 
-    // the thread pool is initialized with 8 threads, all listening for queued
-    // emissions. The number of threads in the pool is not currently run-time
-    // configurable but may be in the future.
+    // the global thread pool is initialized, all threads listening for queued
+    // emissions. A slot can instead be connected to a pool of its own, which
+    // is started on the first connection to it.
     // Emitted parameters are bound to the mapped function and enqueued on the 
     // one of the waiting threads. These messages are then processed when the 
     // relevant queue is consumed by the mapped thread pool.
@@ -89,207 +100,643 @@ public:
     
     ~SignalImpl(){
         disconnectAllSlots();
+        delete slotList.load(std::memory_order_relaxed);
     }
 
+    //Slots are dispatched in order of descending priority, then connection
+    //A non zero queue capacity bounds the queue of a strand slot, a bounded
+    //strand slot with a single producer (one emitting thread at a time)
+    //queues through an SPSC ring
+    template<typename F, typename C>
+    int connectMemberSlot(const ExecutorScheme &scheme, F&& function, C&& instance, int32_t priority = 0, 
+            uint32_t queueCapacity = 0, OverflowPolicy overflow = OverflowPolicy::BLOCK, bool singleProducer = false) const {
+        return (int)connectMember(scheme, std::forward<F>(function), std::forward<C>(instance), priority, queueCapacity, overflow, singleProducer)->id;
+    }
+    
+    template<typename F>
+    int connectSlot(const ExecutorScheme &scheme, F&& function, int32_t priority = 0, 
+            uint32_t queueCapacity = 0, OverflowPolicy overflow = OverflowPolicy::BLOCK, bool singleProducer = false) const {
+        return (int)connect(scheme, std::forward<F>(function), priority, queueCapacity, overflow, singleProducer)->id;
+    }
+    
     template<typename F, typename C>
-    int connectMemberSlot(const ExecutorScheme &scheme, F&& function, C&& instance) const {
+    std::shared_ptr<BSignals::details::SlotLink> connectMember(const ExecutorScheme &scheme, F&& function, C&& instance, int32_t priority = 0, 
+            uint32_t queueCapacity = 0, OverflowPolicy overflow = OverflowPolicy::BLOCK, bool singleProducer = false) const {
         //type check assertions
         static_assert(std::is_member_function_pointer<F>::value, "function is not a member function");
         static_assert(std::is_object<std::remove_reference<C>>::value, "instance is not a class object");
         
         //Construct a bound function from the function pointer and object
-        auto boundFunc = objectBind(function, instance);
-        return connectSlot(scheme, boundFunc);
+        return connect(scheme, objectBind(function, instance), priority, queueCapacity, overflow, singleProducer);
     }
     
-    int connectSlot(const ExecutorScheme &scheme, std::function<void(Args...)> slot) const {
-        std::unique_lock<std::shared_timed_mutex> lock(signalLock);
-        uint32_t id = currentId.fetch_add(1);
-        auto *slotMap = getSlotMap(scheme);
-        slotMap->emplace(id, slot);
-        if (scheme == ExecutorScheme::STRAND){
-            strandQueues[id];
-            strandThreads.emplace(id, std::thread(&SignalImpl::queueListener, this, id));
-        }
-        else if (scheme == ExecutorScheme::THREAD_POOLED){
-            BSignals::details::WheeledThreadPool::startup();
-        }
-        return (int)id;
+    //The record is appended into spare capacity of the published list, the
+    //list is only rebuilt when it is full or the slot outranks the last record
+    template<typename F>
+    std::shared_ptr<BSignals::details::SlotLink> connect(const ExecutorScheme &scheme, F&& function, int32_t priority = 0, 
+            uint32_t queueCapacity = 0, OverflowPolicy overflow = OverflowPolicy::BLOCK, bool singleProducer = false) const {
+        BSignals::details::WheeledThreadPool *pool = scheme == ExecutorScheme::THREAD_POOLED ? &BSignals::details::WheeledThreadPool::global() : nullptr;
+        return connectFunction(scheme, pool, SlotFunction(std::forward<F>(function)), priority, queueCapacity, overflow, singleProducer);
+    }
+    
+    //A thread pooled slot run by the given pool rather than the global one
+    //The pool must outlive the connection
+    template<typename F, typename C>
+    int connectMemberSlot(BSignals::details::WheeledThreadPool &pool, F&& function, C&& instance, int32_t priority = 0) const {
+        return (int)connectMember(pool, std::forward<F>(function), std::forward<C>(instance), priority)->id;
+    }
+    
+    template<typename F>
+    int connectSlot(BSignals::details::WheeledThreadPool &pool, F&& function, int32_t priority = 0) const {
+        return (int)connect(pool, std::forward<F>(function), priority)->id;
+    }
+    
+    template<typename F, typename C>
+    std::shared_ptr<BSignals::details::SlotLink> connectMember(BSignals::details::WheeledThreadPool &pool, F&& function, C&& instance, int32_t priority = 0) const {
+        static_assert(std::is_member_function_pointer<F>::value, "function is not a member function");
+        static_assert(std::is_object<std::remove_reference<C>>::value, "instance is not a class object");
+        return connect(pool, objectBind(function, instance), priority);
+    }
+    
+    template<typename F>
+    std::shared_ptr<BSignals::details::SlotLink> connect(BSignals::details::WheeledThreadPool &pool, F&& function, int32_t priority = 0) const {
+        return connectFunction(ExecutorScheme::THREAD_POOLED, &pool, SlotFunction(std::forward<F>(function)), priority);
+    }
+    
+    //Removes the slot from emission straight away without waiting for queued
+    //work. Queued and running tasks drain in the background, the returned
+    //future is ready once they have finished. Other slots are finished on return
+    std::shared_future<void> disconnectSlotAsync(const uint32_t &id) const {
+        std::lock_guard<std::mutex> lock(signalLock);
+        auto it = slotIndex.find(id);
+        if (it == slotIndex.end()) return finished();
+        return disconnect(it);
     }
     
     void disconnectSlot(const uint32_t &id) const {
-        std::unique_lock<std::shared_timed_mutex> lock(signalLock);
-        std::map<uint32_t, std::function<void(Args...)>> *slotMap = findSlotMapWithId(id);
-        if (slotMap == nullptr) return;
-        if (slotMap == &strandSlots){
-            strandQueues[id].enqueue(nullptr);
-            strandThreads[id].join();
-            strandThreads.erase(id);
-            strandQueues.erase(id);
+        disconnectSlotAsync(id).wait();
+        std::lock_guard<std::mutex> lock(signalLock);
+        reclaimDrained();
+        reclaimer.reclaim();
+    }
+    
+    //Queue counters of every connected strand slot, keyed by slot id
+    std::map<uint32_t, BSignals::details::QueueStats> queueStats() const {
+        std::lock_guard<std::mutex> lock(signalLock);
+        std::map<uint32_t, BSignals::details::QueueStats> stats;
+        for (auto &s : slotIndex){
+            if (s.second->strand) stats.emplace(s.first, s.second->strand->stats());
         }
-        slotMap->erase(id);
+        return stats;
     }
     
     void disconnectAllSlots() const { 
-        std::unique_lock<std::shared_timed_mutex> lock(signalLock);
-        for (auto &q : strandQueues){
-            q.second.enqueue(nullptr);
+        std::vector<std::shared_future<void>> pending;
+        {
+            std::lock_guard<std::mutex> lock(signalLock);
+            for (auto &s : slotIndex){
+                s.second->state.fetch_or(SlotLink::disconnectedBit, std::memory_order_release);
+                s.second->stop();
+                deadSlots.push_back(std::move(s.second));
+            }
+            slotIndex.clear();
+            publish(new SlotList(minCapacity));
+            for (auto &s : deadSlots) retireSlot(std::move(s));
+            deadSlots.clear();
+            for (auto &s : drainingSlots){
+                pending.push_back(s->stop());
+            }
         }
-        for (auto &t : strandThreads){
-            t.second.join();
+        //queued work drains without holding the lock
+        for (auto &f : pending) f.wait();
+        std::lock_guard<std::mutex> lock(signalLock);
+        reclaimDrained();
+        reclaimer.reclaim();
+    }
+    
+    //Returns false if a bounded FAIL_FAST strand slot rejected the emission
+    bool emitSignal(typename Param<Args>::type... p) const {
+        if (enableEmissionGuard){
+            BSignals::details::EpochReclaimer::ReadGuard guard;
+            return emitSignalUnsafe(p...);
         }
-        strandThreads.clear();
-        strandQueues.clear();
-        
-        synchronousSlots.clear();
-        asynchronousSlots.clear();
-        strandSlots.clear();
-        threadPooledSlots.clear();
+        return emitSignalUnsafe(p...);
+    }
+    
+    //Rvalue emission, the final slot receives the arguments by move
+    //Only declared when at least one argument is passed by reference
+    template <bool B = !AllPassByValue<Args...>::value, typename = typename std::enable_if<B>::type>
+    bool emitSignal(typename ForwardParam<Args>::type... p) const {
+        if (enableEmissionGuard){
+            BSignals::details::EpochReclaimer::ReadGuard guard;
+            return emitSignalUnsafe(std::forward<typename ForwardParam<Args>::type>(p)...);
+        }
+        return emitSignalUnsafe(std::forward<typename ForwardParam<Args>::type>(p)...);
+    }
+    
+    //Emits every element in order, each element is the argument for single
+    //argument signals or a tuple of the arguments otherwise.
+    //Queued tasks are collected per slot and each strand/pool queue receives
+    //the whole batch with a single exchange and a single wakeup
+    template <typename InputIt>
+    bool emitSignalBatch(InputIt first, InputIt last) const {
+        if (enableEmissionGuard){
+            BSignals::details::EpochReclaimer::ReadGuard guard;
+            return emitBatchUnsafe(first, last);
+        }
+        return emitBatchUnsafe(first, last);
     }
     
-    void emitSignal(const Args &... p) const {
-        return enableEmissionGuard ? emitSignalThreadSafe(p...) : emitSignalUnsafe(p...);
+    template <typename E>
+    bool emitSignalBatch(const E *batch, std::size_t count) const {
+        return emitSignalBatch(batch, batch + count);
     }
     
 private:
+    typedef BSignals::details::UniqueFunction<void(typename SlotParam<Args>::type...)> SlotFunction;
+    typedef BSignals::details::SharedPayload<Args...> Payload;
+    typedef BSignals::details::TaskQueue::Chain TaskChain;
+    typedef BSignals::details::SlotLink SlotLink;
+    
+    //Fan out to several queued slots shares one payload per emission, unless
+    //the arguments are cheaper to copy into each task than to reference count
+    static constexpr bool sharePayload = !AllPassByValue<Args...>::value && IsShareable<Args...>::value;
+    
+    //Smallest slot list allocated, and the tombstone count always tolerated
+    static constexpr uint32_t minCapacity = 8;
+    
+    //Slot list size up to which a batch emission needs no heap allocation
+    static constexpr uint32_t batchInlineChains = 16;
+    
+    //Connected slot, address is stable for the lifetime of the connection
+    //The strand is only created for STRAND slots, the pool is only set for
+    //THREAD_POOLED slots
+    struct Slot : public SlotLink{
+        Slot(const SignalImpl *signal, uint32_t id, ExecutorScheme slotScheme, SlotFunction &&slotFunction)
+            : SlotLink(id), owner(signal), scheme(slotScheme), function(std::move(slotFunction)) {}
+        
+        void disconnect() override {
+            owner->disconnectSlot(id);
+        }
+        
+        //Stops further tasks, the future is ready once the queued ones have finished
+        std::shared_future<void> stop(){
+            std::shared_future<void> done = inFlight.close();
+            return strand ? strand->stopAsync() : done;
+        }
+        
+        bool isDrained() const{
+            return strand ? strand->isDrained() : inFlight.isDrained();
+        }
+        
+        const SignalImpl *owner;
+        const ExecutorScheme scheme;
+        SlotFunction function;
+        std::unique_ptr<BSignals::details::Strand> strand;
+        BSignals::details::WheeledThreadPool *pool{nullptr};
+        
+        //Asynchronous and thread pooled tasks of this slot not yet finished
+        BSignals::details::InFlightCount inFlight;
+    };
+    
+    //Dispatch record, holds everything emission needs without touching the index
+    struct SlotRecord{
+        ExecutorScheme scheme;
+        int32_t priority;
+        Slot *slot;
+    };
+    
+    //Records are sorted by descending priority, executors interleaved.
+    //Records are appended in place into spare capacity and disconnected slots
+    //stay behind as tombstones that emission skips. The list is only copied
+    //when it is full, mostly tombstones, or a slot is connected ahead of the
+    //last record, so connect/disconnect at equal priority is amortized O(1)
+    struct SlotList{
+        explicit SlotList(uint32_t size) 
+            : records(new SlotRecord[size]), capacity(size) {}
+        
+        std::unique_ptr<SlotRecord[]> records;
+        const uint32_t capacity;
+        
+        //Stored with release once the record has been written
+        std::atomic<uint32_t> size{0};
+        
+        //Queued records appended so far, an upper bound for the visible records
+        std::atomic<uint32_t> queuedCount{0};
+        
+        //One past the last synchronous record appended so far, zero if none
+        std::atomic<uint32_t> synchronousEnd{0};
+        
+        //Only used by writers
+        uint32_t tombstones{0};
+    };
+    
     SignalImpl<Args...>(const SignalImpl<Args...>& that) = delete;
     void operator=(const SignalImpl<Args...>&) = delete;
     
-    inline void emitSignalUnsafe(const Args &... p) const {
-        for (auto const &slot : synchronousSlots){
-            runSynchronous(slot.second, p...);
+    //A thread pooled slot is given its pool, which is started if need be
+    //Move only arguments can only be handed to one slot, a second is rejected
+    //A single producer strand needs a bounded ring and a policy the producer
+    //can apply alone, other combinations throw std::invalid_argument
+    std::shared_ptr<BSignals::details::SlotLink> connectFunction(const ExecutorScheme &scheme, BSignals::details::WheeledThreadPool *pool, SlotFunction &&function, 
+            int32_t priority, uint32_t queueCapacity = 0, OverflowPolicy overflow = OverflowPolicy::BLOCK, bool singleProducer = false) const {
+        std::lock_guard<std::mutex> lock(signalLock);
+        if (!IsShareable<Args...>::value && !slotIndex.empty()){
+            throw std::logic_error("signal with move only arguments already has a slot");
         }
-        
-        for (auto const &slot : asynchronousSlots){
-            runAsynchronous(slot.second, p...);
+        if (scheme == ExecutorScheme::STRAND && singleProducer){
+            if (queueCapacity == 0){
+                throw std::invalid_argument("single producer strand needs a queue capacity");
+            }
+            if (overflow == OverflowPolicy::DROP_OLDEST){
+                throw std::invalid_argument("single producer strand can't drop its oldest task");
+            }
+        }
+        uint32_t id = currentId.fetch_add(1);
+        auto newSlot = std::make_shared<Slot>(this, id, scheme, std::move(function));
+        if (scheme == ExecutorScheme::STRAND){
+            newSlot->strand.reset(queueCapacity ? new BSignals::details::Strand(queueCapacity, overflow, singleProducer) : 
+                new BSignals::details::Strand);
+        }
+        else if (scheme == ExecutorScheme::THREAD_POOLED){
+            newSlot->pool = pool;
+            pool->startup();
         }
         
-        for (auto const &slot : strandSlots){
-            runStrands(slot.first, slot.second, p...);
+        SlotRecord record{scheme, priority, newSlot.get()};
+        SlotList &list = *slotList.load(std::memory_order_relaxed);
+        uint32_t size = list.size.load(std::memory_order_relaxed);
+        if (size == list.capacity || (size > 0 && list.records[size-1].priority < priority)){
+            rebuild(&record);
+        }
+        else{
+            append(list, record);
         }
+        slotIndex.emplace(id, newSlot);
+        return newSlot;
+    }
+    
+    //Must be called with signalLock held
+    void append(SlotList &list, const SlotRecord &record) const{
+        uint32_t size = list.size.load(std::memory_order_relaxed);
+        list.records[size] = record;
+        if (record.scheme != ExecutorScheme::SYNCHRONOUS){
+            list.queuedCount.store(list.queuedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        else{
+            list.synchronousEnd.store(size + 1, std::memory_order_relaxed);
+        }
+        list.size.store(size + 1, std::memory_order_release);
+    }
+    
+    //Must be called with signalLock held
+    //The slot is marked dead in place, the list is compacted once tombstones
+    //outnumber the live records
+    std::shared_future<void> disconnect(typename std::unordered_map<uint32_t, std::shared_ptr<Slot>>::iterator it) const {
+        std::shared_ptr<Slot> slot = std::move(it->second);
+        slotIndex.erase(it);
+        slot->state.fetch_or(SlotLink::disconnectedBit, std::memory_order_release);
+        
+        std::shared_future<void> drained = slot->stop();
+        deadSlots.push_back(std::move(slot));
         
-        for (auto const &slot : threadPooledSlots){
-            runThreadPooled(slot.second, p...);
+        SlotList &list = *slotList.load(std::memory_order_relaxed);
+        uint32_t live = list.size.load(std::memory_order_relaxed) - ++list.tombstones;
+        if (list.tombstones > std::max(live, minCapacity)) rebuild(nullptr);
+        return drained;
+    }
+    
+    //Must be called with signalLock held
+    //Publishes a copy of the live records with room for as many again, the
+    //inserted record (if any) is placed after every record of equal or higher priority
+    void rebuild(const SlotRecord *inserted) const{
+        SlotList &oldList = *slotList.load(std::memory_order_relaxed);
+        uint32_t size = oldList.size.load(std::memory_order_relaxed);
+        uint32_t live = size - oldList.tombstones + (inserted ? 1 : 0);
+        SlotList *newList = new SlotList(std::max(2*live, minCapacity));
+        for (uint32_t i=0; i<size; ++i){
+            const SlotRecord &record = oldList.records[i];
+            if (inserted && record.priority < inserted->priority){
+                append(*newList, *inserted);
+                inserted = nullptr;
+            }
+            if (record.slot->isConnected()) append(*newList, record);
         }
+        if (inserted) append(*newList, *inserted);
+        publish(newList);
+        for (auto &s : deadSlots) retireSlot(std::move(s));
+        deadSlots.clear();
     }
     
-    inline void emitSignalThreadSafe(const Args &... p) const {
-        std::shared_lock<std::shared_timed_mutex> lock(signalLock);
-        emitSignalUnsafe(p...);
+    //Must be called with signalLock held
+    void publish(SlotList *newList) const{
+        SlotList *oldList = slotList.exchange(newList, std::memory_order_seq_cst);
+        reclaimer.retire(oldList);
+        reclaimDrained();
+        reclaimer.reclaim();
     }
-
-    inline void runThreadPooled(const std::function<void(Args...)> &function, const Args &... p) const {
-        BSignals::details::WheeledThreadPool::run([&function, p...](){function(p...);});
+    
+    //Must be called with signalLock held, and the slot no longer published
+    //A slot is parked until its queued work has drained
+    void retireSlot(std::shared_ptr<Slot> &&slot) const{
+        if (!slot->isDrained()){
+            drainingSlots.push_back(std::move(slot));
+        }
+        else{
+            reclaimer.retire(new std::shared_ptr<Slot>(std::move(slot)));
+        }
     }
     
-    inline void runAsynchronous(const std::function<void(Args...)> &function, const Args &... p) const {
-        sem.acquire();
-        std::thread slotThread([this, function, p...](){
-            function(p...);
-            sem.release();                
-        });
-        slotThread.detach();
+    //Must be called with signalLock held
+    void reclaimDrained() const{
+        auto drained = std::partition(drainingSlots.begin(), drainingSlots.end(), 
+            [](const std::shared_ptr<Slot> &s){ return !s->isDrained(); });
+        for (auto it = drained; it != drainingSlots.end(); ++it){
+            reclaimer.retire(new std::shared_ptr<Slot>(std::move(*it)));
+        }
+        drainingSlots.erase(drained, drainingSlots.end());
     }
     
-    inline void runStrands(uint32_t asyncQueueId, const std::function<void(Args...)> &function, const Args &... p) const{
-        //bind the function arguments to the function using a lambda and store
-        //the newly bound function. This changes the function signature in the
-        //resultant map, there are no longer any parameters in the bound function
-        strandQueues[asyncQueueId].enqueue([&function, p...](){function(p...);});
+    static std::shared_future<void> finished(){
+        static const std::shared_future<void> done = [](){
+            std::promise<void> p;
+            p.set_value();
+            return p.get_future().share();
+        }();
+        return done;
     }
     
-    inline void runSynchronous(const std::function<void(Args...)> &function, const Args &... p) const{
-        function(p...);
+    template <typename... P>
+    inline bool emitSignalUnsafe(P&&... p) const {
+        return emitToSlots(std::integral_constant<bool, IsShareable<Args...>::value>{}, std::forward<P>(p)...);
     }
     
-    //Reference to instance
-    template<typename F, typename I>
-    std::function<void(Args...)> objectBind(F&& function, I&& instance) const {
-        return[=, &instance](Args... args){
-            (instance.*function)(args...);
-        };
+    //Every slot but the last sees the arguments as lvalues, the last one 
+    //receives them forwarded so that rvalue emission moves rather than copies
+    template <typename... P>
+    inline bool emitToSlots(std::true_type, P&&... p) const {
+        const SlotList &list = *slotList.load(std::memory_order_seq_cst);
+        const uint32_t size = list.size.load(std::memory_order_acquire);
+        if (sharePayload && list.queuedCount.load(std::memory_order_relaxed) > 1){
+            return emitShared(list, size, std::forward<P>(p)...);
+        }
+        if (size == 0) return true;
+        bool accepted = true;
+        const SlotRecord *records = list.records.get();
+        const SlotRecord *last = records + size - 1;
+        for (const SlotRecord *it = records; it != last; ++it){
+            if (it->slot->isActive()) accepted &= dispatch(*it, static_cast<const P&>(p)...);
+        }
+        if (last->slot->isActive()) accepted &= dispatch(*last, std::forward<P>(p)...);
+        return accepted;
     }
     
-    //Pointer to instance
-    template<typename F, typename I>
-    std::function<void(Args...)> objectBind(F&& function, I* instance) const {
-        return objectBind(function, *instance);
+    //Move only arguments cannot be handed to more than one slot, at most one
+    //is connected. A disconnected slot may still be listed ahead of it
+    template <typename... P>
+    inline bool emitToSlots(std::false_type, P&&... p) const {
+        const SlotList &list = *slotList.load(std::memory_order_seq_cst);
+        const uint32_t size = list.size.load(std::memory_order_acquire);
+        const SlotRecord *records = list.records.get();
+        for (uint32_t i=0; i<size; ++i){
+            if (records[i].slot->isActive()) return dispatch(records[i], std::forward<P>(p)...);
+        }
+        return true;
     }
     
-    std::map<uint32_t, std::function<void(Args...)>> *getSlotMap(const ExecutorScheme &scheme) const{
-        switch(scheme){
+    template <typename... P>
+    inline bool dispatch(const SlotRecord &record, P&&... p) const {
+        Slot &slot = *record.slot;
+        switch (record.scheme){
+            case (ExecutorScheme::SYNCHRONOUS):
+                runSynchronous(slot.function, std::forward<P>(p)...);
+                break;
             case (ExecutorScheme::ASYNCHRONOUS):
-                return &asynchronousSlots;
+                runAsynchronous(slot, std::forward<P>(p)...);
+                break;
             case (ExecutorScheme::STRAND):
-                return &strandSlots;
+                return runStrands(*slot.strand, slot.function, std::forward<P>(p)...);
             case (ExecutorScheme::THREAD_POOLED):
-                return &threadPooledSlots;
-            default:
-            case (ExecutorScheme::SYNCHRONOUS):
-                return &synchronousSlots;
+                runThreadPooled(slot, std::forward<P>(p)...);
+                break;
         }
+        return true;
     }
     
-    std::map<uint32_t, std::function<void(Args...)>> *findSlotMapWithId(const uint32_t &id) const{
-        if (synchronousSlots.count(id))
-            return &synchronousSlots;
-        if (asynchronousSlots.count(id))
-            return &asynchronousSlots;
-        if (strandSlots.count(id))
-            return &strandSlots;
-        if (threadPooledSlots.count(id))
-            return &threadPooledSlots;
-        return nullptr;
+    //Queued slots all reference one payload, created at the first of them.
+    //The payload takes the forwarded arguments unless a synchronous slot
+    //still follows, and is sized for every queued record with unused
+    //references dropped at the end
+    template <typename... P>
+    inline bool emitShared(const SlotList &list, uint32_t size, P&&... p) const {
+        bool accepted = true;
+        const SlotRecord *records = list.records.get();
+        uint32_t refs = list.queuedCount.load(std::memory_order_relaxed);
+        uint32_t synchronousEnd = list.synchronousEnd.load(std::memory_order_relaxed);
+        Payload *payload = nullptr;
+        for (uint32_t i=0; i<size; ++i){
+            const SlotRecord &record = records[i];
+            if (!record.slot->isActive()) continue;
+            if (record.scheme == ExecutorScheme::SYNCHRONOUS){
+                runSynchronous(record.slot->function, static_cast<const P&>(p)...);
+                continue;
+            }
+            if (!payload){
+                payload = (i >= synchronousEnd) ? Payload::create(refs, std::forward<P>(p)...) :
+                    Payload::create(refs, static_cast<const P&>(p)...);
+            }
+            --refs;
+            typename Payload::Ref ref(payload);
+            switch (record.scheme){
+                case (ExecutorScheme::ASYNCHRONOUS):
+                    runAsynchronous(*record.slot, std::move(ref));
+                    break;
+                case (ExecutorScheme::STRAND):
+                    accepted &= runStrands(*record.slot->strand, record.slot->function, std::move(ref));
+                    break;
+                case (ExecutorScheme::THREAD_POOLED):
+                    runThreadPooled(*record.slot, std::move(ref));
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (payload && refs) payload->release(refs);
+        return accepted;
     }
-        
-    void queueListener(const uint32_t &id) const{
-        auto &q = strandQueues[id];
-        std::function<void()> func = [](){};
-        auto maxWait = BSignals::details::WheeledThreadPool::getMaxWait();
-        std::chrono::duration<double> waitTime = std::chrono::nanoseconds(1);
-        while (func){
-            if (q.dequeue(func)){
-                if (func) func();
-                waitTime = std::chrono::nanoseconds(1);
+    
+    template <typename InputIt>
+    inline bool emitBatchUnsafe(InputIt first, InputIt last) const {
+        const SlotList &list = *slotList.load(std::memory_order_seq_cst);
+        const uint32_t size = list.size.load(std::memory_order_acquire);
+        if (size == 0) return true;
+        //one chain per record, only strand and thread pooled records fill theirs
+        //Common slot counts keep the chains on the stack
+        TaskChain inlineChains[batchInlineChains];
+        std::unique_ptr<TaskChain[]> heapChains;
+        TaskChain *chains = inlineChains;
+        if (size > batchInlineChains){
+            heapChains.reset(new TaskChain[size]);
+            chains = heapChains.get();
+        }
+        auto emitOne = [this, &list, size, chains](typename Param<Args>::type... p){
+            emitIntoChains(list, size, chains, p...);
+        };
+        for (; first != last; ++first){
+            BatchElement<sizeof...(Args)>::apply(emitOne, *first);
+        }
+        bool accepted = true;
+        for (uint32_t i=0; i<size; ++i){
+            if (chains[i].empty()) continue;
+            const SlotRecord &record = list.records[i];
+            if (record.scheme == ExecutorScheme::STRAND) accepted &= record.slot->strand->enqueue(std::move(chains[i]));
+            else record.slot->pool->run(std::move(chains[i]));
+        }
+        return accepted;
+    }
+    
+    template <typename... P>
+    inline void emitIntoChains(const SlotList &list, uint32_t size, TaskChain *chains, const P&... p) const {
+        const SlotRecord *records = list.records.get();
+        uint32_t refs = list.queuedCount.load(std::memory_order_relaxed);
+        const bool share = sharePayload && refs > 1;
+        Payload *payload = nullptr;
+        for (uint32_t i=0; i<size; ++i){
+            const SlotRecord &record = records[i];
+            if (!record.slot->isActive()) continue;
+            if (record.scheme == ExecutorScheme::SYNCHRONOUS){
+                runSynchronous(record.slot->function, p...);
             }
-            else{
-                std::this_thread::sleep_for(waitTime);
-                waitTime*=2;
+            else if (share){
+                if (!payload) payload = Payload::create(refs, p...);
+                --refs;
+                queueIntoChain(record, chains[i], typename Payload::Ref(payload));
             }
-            if (waitTime > maxWait){
-                q.blockingDequeue(func);
-                if (func) func();
-                waitTime = std::chrono::nanoseconds(1);
+            else{
+                queueIntoChain(record, chains[i], p...);
             }
         }
+        if (payload && refs) payload->release(refs);
     }
     
-    //Shared mutex for thread safety
-    //Emit acquires shared lock, connect/disconnect acquires unique lock
-    mutable std::shared_timed_mutex signalLock;
+    template <typename... P>
+    inline void queueIntoChain(const SlotRecord &record, TaskChain &chain, P&&... p) const {
+        if (record.scheme == ExecutorScheme::ASYNCHRONOUS){
+            runAsynchronous(*record.slot, std::forward<P>(p)...);
+        }
+        else if (record.scheme == ExecutorScheme::STRAND){
+            chain.push(makeTask(boundTask(record.slot->function, std::forward<P>(p)...)));
+        }
+        else{
+            auto token = record.slot->inFlight.tryAcquire();
+            if (!token) return;
+            chain.push(makeTask(BSignals::details::countedTask(std::move(token), 
+                boundTask(record.slot->function, std::forward<P>(p)...))));
+        }
+    }
+    
+    //Queued executors bind the arguments into the task (copied or moved
+    //depending on how they were passed), the task then moves them into the slot
+    //Strand and thread pooled tasks are built in place in a pooled task node
+    template <typename... P>
+    inline auto boundTask(const SlotFunction &function, P&&... p) const {
+        return [&function, args = BoundArgs<Args...>(std::forward<P>(p)...)]() mutable {
+            invokeMoved(function, args);
+        };
+    }
+    
+    //Shared payload variant, the task holds a reference rather than the arguments
+    inline auto boundTask(const SlotFunction &function, typename Payload::Ref &&ref) const {
+        return [&function, ref = std::move(ref)](){
+            invokeShared(function, ref.args());
+        };
+    }
+    
+    //Pooled tasks hold a token of the slot, disconnecting waits for them
+    template <typename... P>
+    inline void runThreadPooled(Slot &slot, P&&... p) const {
+        auto token = slot.inFlight.tryAcquire();
+        if (!token) return;
+        slot.pool->run(makeTask(BSignals::details::countedTask(std::move(token), 
+            boundTask(slot.function, std::forward<P>(p)...))));
+    }
+    
+    //The thread holds a token of the slot, so disconnecting the slot waits for
+    //it rather than for every asynchronous thread of the signal
+    template <typename... P>
+    inline void runAsynchronous(Slot &slot, P&&... p) const {
+        auto token = slot.inFlight.tryAcquire();
+        if (!token) return;
+        sem.acquire();
+        std::thread slotThread([this, task = BSignals::details::countedTask(std::move(token), 
+                boundTask(slot.function, std::forward<P>(p)...))]() mutable {
+            task();
+            sem.release();                
+        });
+        slotThread.detach();
+    }
+    
+    template <typename... P>
+    inline bool runStrands(BSignals::details::Strand &strand, const SlotFunction &function, P&&... p) const{
+        //bind the function arguments to the function using a lambda and store
+        //the newly bound function. This changes the function signature in the
+        //resultant queue, there are no longer any parameters in the bound function
+        return strand.enqueue(makeTask(boundTask(function, std::forward<P>(p)...)));
+    }
+    
+    template <typename... P>
+    inline void runSynchronous(const SlotFunction &function, P&&... p) const{
+        function(std::forward<P>(p)...);
+    }
+    
+    //Reference to instance
+    template<typename F, typename I>
+    auto objectBind(F&& function, I&& instance) const {
+        return[=, &instance](typename SlotParam<Args>::type... args){
+            (instance.*function)(std::forward<typename SlotParam<Args>::type>(args)...);
+        };
+    }
+    
+    //Pointer to instance
+    template<typename F, typename I>
+    auto objectBind(F&& function, I* instance) const {
+        return objectBind(function, *instance);
+    }
+    
+    //Serialises connect/disconnect, emission never takes this lock
+    mutable std::mutex signalLock;
     
     //Atomically incremented slotId
     mutable std::atomic<uint32_t> currentId {0};
     
-    //Async Emit Semaphore
+    //Async Emit Semaphore, only bounds the number of threads
     mutable BSignals::details::Semaphore sem {1024};
     
-    //EmissionGuard determines if it is necessary to guard emission with a shared mutex
+    //EmissionGuard determines if emission must enter an epoch read section
     //This is only required if connection/disconnection could be interleaved with emission
     const bool enableEmissionGuard {false};
     
-    //Strand Queues and Threads
-    mutable std::map<uint32_t, BSignals::details::MPSCQueue<std::function<void()>>> strandQueues;
-    mutable std::map<uint32_t, std::thread> strandThreads;
+    //Slots are owned by the id index, which is only used on connect/disconnect
+    //Handles share ownership so that a slot they refer to is never freed under them
+    mutable std::unordered_map<uint32_t, std::shared_ptr<Slot>> slotIndex;
+    
+    //Disconnected slots still present as tombstones in the published list
+    mutable std::vector<std::shared_ptr<Slot>> deadSlots;
     
-    //Slot Maps
-    mutable std::map<uint32_t, std::function<void(Args...)>> synchronousSlots;
-    mutable std::map<uint32_t, std::function<void(Args...)>> asynchronousSlots;
-    mutable std::map<uint32_t, std::function<void(Args...)>> strandSlots;
-    mutable std::map<uint32_t, std::function<void(Args...)>> threadPooledSlots;
+    //Disconnected slots still draining their queued work
+    mutable std::vector<std::shared_ptr<Slot>> drainingSlots;
+    
+    //Flat dispatch array walked on emission, published atomically
+    mutable std::atomic<SlotList*> slotList {new SlotList(minCapacity)};
+    
+    //Defers freeing of unpublished slot lists and slots until no emitter can see them
+    mutable BSignals::details::EpochReclaimer reclaimer;
 
 };
 
+template <typename... Args>
+constexpr uint32_t SignalImpl<Args...>::minCapacity;
+
 }}
 
 #endif /* SIGNALIMPL_HPP */
@@ -0,0 +1,331 @@
+/*
+ * File:   StaticSignalImpl.hpp
+ * Signal with a single executor fixed at compile time.
+ * Each executor only carries the state it needs and the emit loop is
+ * generated for that executor alone, with no per slot dispatch.
+ * Only the executor dispatch is removed. Slots are still stored type erased,
+ * so a synchronous emission makes one indirect call per slot and the slot
+ * bodies are not inlined into the loop.
+ */
+
+#ifndef STATICSIGNALIMPL_HPP
+#define STATICSIGNALIMPL_HPP
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
+
+#include "BSignals/details/SignalImpl.hpp"
+#include "BSignals/details/InFlightCount.h"
+
+namespace BSignals{ namespace details{
+
+template <ExecutorScheme scheme, typename... Args>
+class StaticExecutor;
+
+template <typename... Args>
+class StaticExecutor<ExecutorScheme::SYNCHRONOUS, Args...>{
+public:
+    struct Slot{
+        UniqueFunction<void(Args...)> function;
+    };
+    
+    void connect(Slot &) {}
+    void disconnect(Slot &) {}
+    void drain(Slot &) {}
+    
+    template <typename... P>
+    inline bool run(Slot &slot, P&&... p){
+        slot.function(std::forward<P>(p)...);
+        return true;
+    }
+};
+
+template <typename... Args>
+class StaticExecutor<ExecutorScheme::ASYNCHRONOUS, Args...>{
+public:
+    StaticExecutor() = default;
+    
+    StaticExecutor(uint32_t maxAsyncThreads)
+        : sem{maxAsyncThreads} {}
+    
+    struct Slot{
+        UniqueFunction<void(Args...)> function;
+        InFlightCount inFlight;
+    };
+    
+    void connect(Slot &) {}
+    
+    //detached threads reference the slot until they complete, each holds a
+    //token of the slot so only its own threads are waited for
+    void disconnect(Slot &slot){
+        slot.inFlight.close();
+    }
+    
+    void drain(Slot &slot){
+        slot.inFlight.close().wait();
+    }
+    
+    template <typename... P>
+    inline bool run(Slot &slot, P&&... p){
+        auto token = slot.inFlight.tryAcquire();
+        if (!token) return true;
+        sem.acquire();
+        std::thread slotThread([this, task = countedTask(std::move(token), 
+                [&slot, args = BoundArgs<Args...>(std::forward<P>(p)...)]() mutable {
+            invokeMoved(slot.function, args);
+        })]() mutable {
+            task();
+            sem.release();
+        });
+        slotThread.detach();
+        return true;
+    }
+    
+private:
+    BSignals::details::Semaphore sem {1024};
+};
+
+template <typename... Args>
+class StaticExecutor<ExecutorScheme::STRAND, Args...>{
+public:
+    struct Slot{
+        UniqueFunction<void(Args...)> function;
+        std::unique_ptr<BSignals::details::Strand> strand;
+    };
+    
+    void connect(Slot &slot){
+        slot.strand.reset(new BSignals::details::Strand);
+    }
+    
+    void disconnect(Slot &slot){
+        slot.strand->stopAsync();
+    }
+    
+    void drain(Slot &slot){
+        slot.strand->stop();
+    }
+    
+    template <typename... P>
+    inline bool run(Slot &slot, P&&... p){
+        return slot.strand->enqueue(makeTask([&slot, args = BoundArgs<Args...>(std::forward<P>(p)...)]() mutable {
+            invokeMoved(slot.function, args);
+        }));
+    }
+};
+
+template <typename... Args>
+class StaticExecutor<ExecutorScheme::THREAD_POOLED, Args...>{
+public:
+    struct Slot{
+        UniqueFunction<void(Args...)> function;
+        InFlightCount inFlight;
+    };
+    
+    void connect(Slot &){
+        BSignals::details::WheeledThreadPool::global().startup();
+    }
+    
+    //queued tasks reference the slot, each holds a token of it
+    void disconnect(Slot &slot){
+        slot.inFlight.close();
+    }
+    
+    void drain(Slot &slot){
+        slot.inFlight.close().wait();
+    }
+    
+    template <typename... P>
+    inline bool run(Slot &slot, P&&... p){
+        auto token = slot.inFlight.tryAcquire();
+        if (!token) return true;
+        BSignals::details::WheeledThreadPool::global().run(makeTask(countedTask(std::move(token), 
+                [&slot, args = BoundArgs<Args...>(std::forward<P>(p)...)]() mutable {
+            invokeMoved(slot.function, args);
+        })));
+        return true;
+    }
+};
+
+template <ExecutorScheme scheme, typename... Args>
+class StaticSignalImpl{
+public:
+    StaticSignalImpl() = default;
+    
+    StaticSignalImpl(bool enforceThreadSafety) 
+        : enableEmissionGuard{enforceThreadSafety} {}
+        
+    StaticSignalImpl(uint32_t maxAsyncThreads) 
+        : executor{maxAsyncThreads} {}
+        
+    StaticSignalImpl(bool enforceThreadSafety, uint32_t maxAsyncThreads) 
+        : executor{maxAsyncThreads}, enableEmissionGuard{enforceThreadSafety} {}
+    
+    ~StaticSignalImpl(){
+        disconnectAllSlots();
+        delete slotList.load(std::memory_order_relaxed);
+    }
+    
+    template<typename F, typename C>
+    int connectMemberSlot(F&& function, C&& instance) const {
+        static_assert(std::is_member_function_pointer<F>::value, "function is not a member function");
+        static_assert(std::is_object<std::remove_reference<C>>::value, "instance is not a class object");
+        return connectSlot(objectBind(function, instance));
+    }
+    
+    //Move only arguments can only be handed to one slot, a second is rejected
+    template<typename F>
+    int connectSlot(F&& slot) const {
+        std::lock_guard<std::mutex> lock(signalLock);
+        if (!IsShareable<Args...>::value && !slotIndex.empty()){
+            throw std::logic_error("signal with move only arguments already has a slot");
+        }
+        uint32_t id = currentId.fetch_add(1);
+        std::unique_ptr<Slot> newSlot(new Slot{{std::forward<F>(slot)}});
+        executor.connect(*newSlot);
+        SlotList *newList = new SlotList(*slotList.load(std::memory_order_relaxed));
+        newList->push_back(newSlot.get());
+        slotIndex.emplace_back(id, std::move(newSlot));
+        publish(newList);
+        return (int)id;
+    }
+    
+    //The slot stops taking work under the lock, its queued work is waited for
+    //outside it so that other slots can still be connected and disconnected
+    void disconnectSlot(const uint32_t &id) const {
+        std::unique_ptr<Slot> slot;
+        {
+            std::lock_guard<std::mutex> lock(signalLock);
+            auto it = std::find_if(slotIndex.begin(), slotIndex.end(), 
+                [id](const IndexEntry &e){ return e.first == id; });
+            if (it == slotIndex.end()) return;
+            slot = std::move(it->second);
+            slotIndex.erase(it);
+            SlotList *newList = new SlotList(*slotList.load(std::memory_order_relaxed));
+            newList->erase(std::find(newList->begin(), newList->end(), slot.get()));
+            publish(newList);
+            executor.disconnect(*slot);
+        }
+        executor.drain(*slot);
+        std::lock_guard<std::mutex> lock(signalLock);
+        reclaimer.retire(slot.release());
+    }
+    
+    void disconnectAllSlots() const {
+        std::vector<IndexEntry> slots;
+        {
+            std::lock_guard<std::mutex> lock(signalLock);
+            publish(new SlotList);
+            slots.swap(slotIndex);
+            for (auto &e : slots) executor.disconnect(*e.second);
+        }
+        for (auto &e : slots) executor.drain(*e.second);
+        std::lock_guard<std::mutex> lock(signalLock);
+        for (auto &e : slots) reclaimer.retire(e.second.release());
+    }
+    
+    //Same convention as Signal, a strand slot's queue is unbounded so
+    //emission is always accepted
+    bool emitSignal(typename Param<Args>::type... p) const {
+        if (enableEmissionGuard){
+            BSignals::details::EpochReclaimer::ReadGuard guard;
+            return emitSignalUnsafe(p...);
+        }
+        return emitSignalUnsafe(p...);
+    }
+    
+    //Rvalue emission, the final slot receives the arguments by move
+    template <bool B = !AllPassByValue<Args...>::value, typename = typename std::enable_if<B>::type>
+    bool emitSignal(typename ForwardParam<Args>::type... p) const {
+        if (enableEmissionGuard){
+            BSignals::details::EpochReclaimer::ReadGuard guard;
+            return emitSignalUnsafe(std::forward<typename ForwardParam<Args>::type>(p)...);
+        }
+        return emitSignalUnsafe(std::forward<typename ForwardParam<Args>::type>(p)...);
+    }
+    
+private:
+    typedef typename StaticExecutor<scheme, Args...>::Slot Slot;
+    typedef std::vector<Slot*> SlotList;
+    typedef std::pair<uint32_t, std::unique_ptr<Slot>> IndexEntry;
+    
+    StaticSignalImpl(const StaticSignalImpl&) = delete;
+    void operator=(const StaticSignalImpl&) = delete;
+    
+    //Must be called with signalLock held
+    void publish(SlotList *newList) const{
+        SlotList *oldList = slotList.exchange(newList, std::memory_order_seq_cst);
+        reclaimer.retire(oldList);
+        reclaimer.reclaim();
+    }
+    
+    template <typename... P>
+    inline bool emitSignalUnsafe(P&&... p) const {
+        const SlotList &list = *slotList.load(std::memory_order_seq_cst);
+        if (list.empty()) return true;
+        return emitToSlots(std::integral_constant<bool, IsShareable<Args...>::value>{}, list, std::forward<P>(p)...);
+    }
+    
+    //Every slot but the last sees the arguments as lvalues, the last one 
+    //receives them forwarded so that rvalue emission moves rather than copies
+    template <typename... P>
+    inline bool emitToSlots(std::true_type, const SlotList &list, P&&... p) const {
+        bool accepted = true;
+        for (std::size_t i=0; i+1<list.size(); ++i){
+            accepted &= executor.run(*list[i], static_cast<const P&>(p)...);
+        }
+        accepted &= executor.run(*list.back(), std::forward<P>(p)...);
+        return accepted;
+    }
+    
+    //Move only arguments, the list holds at most one slot
+    template <typename... P>
+    inline bool emitToSlots(std::false_type, const SlotList &list, P&&... p) const {
+        return executor.run(*list.front(), std::forward<P>(p)...);
+    }
+    
+    //Reference to instance
+    template<typename F, typename I>
+    auto objectBind(F&& function, I&& instance) const {
+        return[=, &instance](Args... args){
+            (instance.*function)(std::move(args)...);
+        };
+    }
+    
+    //Pointer to instance
+    template<typename F, typename I>
+    auto objectBind(F&& function, I* instance) const {
+        return objectBind(function, *instance);
+    }
+    
+    //Serialises connect/disconnect, emission never takes this lock
+    mutable std::mutex signalLock;
+    
+    //Atomically incremented slotId
+    mutable std::atomic<uint32_t> currentId {0};
+    
+    //Executor state, only what this scheme requires
+    mutable StaticExecutor<scheme, Args...> executor;
+    
+    //EmissionGuard determines if emission must enter an epoch read section
+    const bool enableEmissionGuard {false};
+    
+    //Slots in connection order, owned here and only used on connect/disconnect
+    mutable std::vector<IndexEntry> slotIndex;
+    
+    //Slots walked on emission, published atomically
+    mutable std::atomic<SlotList*> slotList {new SlotList};
+    
+    //Defers freeing of unpublished slot lists and slots until no emitter can see them
+    mutable BSignals::details::EpochReclaimer reclaimer;
+};
+
+}}
+
+#endif /* STATICSIGNALIMPL_HPP */
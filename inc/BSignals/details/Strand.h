@@ -0,0 +1,105 @@
+/* 
+ * File:   Strand.h
+ * Dedicated thread consuming bound emissions from a queue in FIFO order
+ * The queue is unbounded unless a capacity is given, a bounded strand applies
+ * its overflow policy when the ring is full. A bounded strand declared to have
+ * a single producer uses a wait-free SPSC ring instead of the MPMC one, which
+ * rules out DROP_OLDEST
+ */
+
+#ifndef STRAND_H
+#define STRAND_H
+
+#include <thread>
+#include <atomic>
+#include <future>
+#include <memory>
+#include "BSignals/details/TaskQueue.h"
+#include "BSignals/details/BoundedQueue.hpp"
+#include "BSignals/details/SPSCQueue.hpp"
+
+namespace BSignals{ namespace details{
+
+//What a bounded strand does with a task that finds its queue full
+enum class OverflowPolicy{
+    BLOCK,          //the emitter waits for room
+    DROP_NEWEST,    //the new task is discarded
+    DROP_OLDEST,    //the oldest queued task is discarded to make room
+    FAIL_FAST       //the new task is discarded and the emission reports failure
+};
+
+class Strand{
+public:
+    //Spawns the listening thread
+    Strand();
+    
+    //Bounded strand, capacity is rounded up to a power of two
+    //With singleProducer the caller guarantees that no two threads enqueue
+    //concurrently. DROP_OLDEST needs the emitter to dequeue, so it can't be
+    //combined with singleProducer
+    Strand(uint32_t capacity, OverflowPolicy policy, bool singleProducer = false);
+    
+    //Stops the strand if still running
+    ~Strand();
+    
+    //Takes ownership of the task, tasks enqueued after the strand has been
+    //stopped (or rejected by a full bounded strand) are discarded
+    //Returns false only if a FAIL_FAST strand was full
+    inline bool enqueue(BSignals::details::TaskNode *task){
+        if (!open.load(std::memory_order_relaxed)){
+            task->discard();
+            return true;
+        }
+        if (single){
+            if (single->tryEnqueue(std::move(task))) return true;
+            return enqueueSingle(task);
+        }
+        if (bounded) return enqueueBounded(task);
+        queue.enqueue(task);
+        return true;
+    }
+    
+    typedef BSignals::details::TaskQueue::Chain TaskChain;
+    
+    //Queues a run of tasks with a single wakeup of the listening thread
+    //A bounded strand applies its policy to each task in turn
+    bool enqueue(TaskChain &&tasks);
+    
+    //Closes the strand to new tasks without waiting, the backlog drains in
+    //the background. The future is ready once the last task has completed
+    std::shared_future<void> stopAsync();
+    
+    //True once the backlog has drained after stopAsync
+    bool isDrained() const;
+    
+    //Waits for queued tasks to complete, then joins the listening thread
+    void stop();
+    
+    //Counters of whichever queue the strand uses, callable from any thread
+    BSignals::details::QueueStats stats() const;
+    
+private:
+    bool enqueueBounded(BSignals::details::TaskNode *task);
+    
+    //Applies the overflow policy once the single producer ring is full
+    bool enqueueSingle(BSignals::details::TaskNode *task);
+    
+    template <typename Q>
+    void queueListener(Q &taskQueue);
+    
+    BSignals::details::TaskQueue queue;
+    std::unique_ptr<BSignals::details::BoundedQueue<BSignals::details::TaskNode*>> bounded;
+    std::unique_ptr<BSignals::details::SPSCQueue<BSignals::details::TaskNode*>> single;
+    const OverflowPolicy policy{OverflowPolicy::BLOCK};
+    BSignals::details::TaskNode stopMarker;
+    std::atomic<bool> open{true};
+    std::promise<void> drained;
+    std::shared_future<void> drainedFuture;
+    std::thread thread;
+    
+    Strand(const Strand&) = delete;
+    void operator=(const Strand&) = delete;
+};
+}}
+
+#endif /* STRAND_H */
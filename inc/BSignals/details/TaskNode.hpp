@@ -0,0 +1,79 @@
+/*
+ * File:   TaskNode.hpp
+ * Queued task that is also its own queue node
+ * The link and the bound callable share one block drawn from a pool sized for
+ * that callable, so queueing an emission needs no type erasing wrapper and no
+ * separate node, whatever the size of the bound arguments.
+ * A node without a task serves as a marker, listeners use it to stop.
+ */
+
+#ifndef TASKNODE_HPP
+#define TASKNODE_HPP
+
+#include <atomic>
+#include <utility>
+#include <type_traits>
+
+#include "BSignals/details/ObjectPool.hpp"
+
+namespace BSignals{ namespace details{
+
+class TaskNode{
+public:
+    //Marker node, carries no task
+    TaskNode() = default;
+
+    //Runs the task, then returns the node to its pool
+    inline void run(){
+        complete(this, true);
+    }
+
+    //Returns the node to its pool without running the task
+    inline void discard(){
+        complete(this, false);
+    }
+
+    inline bool isMarker() const {
+        return complete == nullptr;
+    }
+
+    std::atomic<TaskNode*> next{nullptr};
+
+protected:
+    typedef void (*Completion)(TaskNode*, bool);
+
+    explicit TaskNode(Completion completion) : complete(completion) {}
+
+private:
+    Completion complete{nullptr};
+
+    TaskNode(const TaskNode&) = delete;
+    void operator=(const TaskNode&) = delete;
+};
+
+template <typename F>
+class BoundTaskNode : public TaskNode{
+public:
+    template <typename G>
+    explicit BoundTaskNode(G&& function)
+        : TaskNode(&BoundTaskNode::complete), task(std::forward<G>(function)) {}
+
+private:
+    static void complete(TaskNode *node, bool execute){
+        BoundTaskNode *self = static_cast<BoundTaskNode*>(node);
+        if (execute) self->task();
+        ObjectPool<BoundTaskNode>::destroy(self);
+    }
+
+    F task;
+};
+
+//The caller owns the node until it is queued
+template <typename F>
+inline TaskNode *makeTask(F&& function){
+    return ObjectPool<BoundTaskNode<typename std::decay<F>::type>>::create(std::forward<F>(function));
+}
+
+}}
+
+#endif /* TASKNODE_HPP */
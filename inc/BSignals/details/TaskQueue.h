@@ -0,0 +1,265 @@
+/*
+ * File:   TaskQueue.h
+ * Intrusive lock free multi-producer single consumer queue of task nodes
+ * Based on Dmitry Vyukov's intrusive MPSC node based queue
+ * http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+ * Nodes are linked through their own next pointer, a stub node owned by the
+ * queue keeps it non-empty so producers never allocate. A blocked reader
+ * parks on an event count, producers only pay a load to check for it.
+ * Depth and throughput are counted with relaxed atomics, see QueueStats.
+ * The producer and consumer ends sit on separate cache lines.
+ */
+
+#ifndef TASKQUEUE_H
+#define TASKQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <chrono>
+#include <thread>
+
+#include "BSignals/details/TaskNode.hpp"
+#include "BSignals/details/CacheLine.h"
+#include "BSignals/details/EventCount.h"
+#include "BSignals/details/QueueStats.h"
+
+namespace BSignals{ namespace details{
+
+class TaskQueue{
+public:
+    TaskQueue();
+
+    //Remaining tasks are discarded
+    ~TaskQueue();
+
+    //The queue owns the node until it is dequeued
+    inline void enqueue(TaskNode *node){
+        node->next.store(nullptr, std::memory_order_relaxed);
+        countEnqueued(1);
+        push(node, node);
+        readerEvent.notify();
+    }
+
+    //Nodes linked privately by one producer, then published to a queue in one go
+    class Chain{
+    public:
+        Chain() = default;
+
+        Chain(Chain &&that) noexcept : first(that.first), last(that.last), count(that.count){
+            that.first = that.last = nullptr;
+            that.count = 0;
+        }
+
+        //Unpublished tasks are discarded
+        ~Chain();
+
+        inline void push(TaskNode *node){
+            node->next.store(nullptr, std::memory_order_relaxed);
+            if (last) last->next.store(node, std::memory_order_relaxed);
+            else first = node;
+            last = node;
+            ++count;
+        }
+
+        //Takes the first task off the chain
+        bool pop(TaskNode *&output);
+
+        bool empty() const {
+            return first == nullptr;
+        }
+
+    private:
+        friend class TaskQueue;
+        TaskNode *first{nullptr};
+        TaskNode *last{nullptr};
+        uint64_t count{0};
+
+        Chain(const Chain&) = delete;
+        void operator=(const Chain&) = delete;
+    };
+
+    //Links every node of the chain with a single exchange and one wakeup
+    void enqueue(Chain &&chain);
+
+    //Only called by the single consumer, the node is handed over to the caller
+    inline bool dequeue(TaskNode *&output){
+        TaskNode *node = tail;
+        TaskNode *next = node->next.load(std::memory_order_acquire);
+        if (node == &stub){
+            if (next == nullptr) return false;
+            stubLinked = false;
+            tail = next;
+            node = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next == nullptr){
+            //a producer is between its exchange and its link
+            if (node != head.load(std::memory_order_acquire)) return false;
+            //the last node can only be handed out once the stub is behind it
+            stub.next.store(nullptr, std::memory_order_relaxed);
+            push(&stub, &stub);
+            stubLinked = true;
+            next = node->next.load(std::memory_order_acquire);
+            if (next == nullptr) return false;
+        }
+        tail = next;
+        output = node;
+        countDequeued(1);
+        return true;
+    }
+
+    //Hands over up to max nodes, returns how many were written
+    template <typename OutputIt>
+    std::size_t dequeueBulk(OutputIt output, std::size_t max){
+        std::size_t count = 0;
+        TaskNode *node;
+        while (count < max && dequeue(node)){
+            *output++ = node;
+            ++count;
+        }
+        return count;
+    }
+
+    //Detaches everything queued so far with a single exchange and hands each
+    //node to consume in FIFO order, returns how many were consumed.
+    //Tasks queued while consume runs are left for the next call
+    template <typename F>
+    std::size_t consumeAll(F &&consume){
+        if (stubLinked && tail != &stub){
+            //the stub was requeued behind a node whose producer had not
+            //linked it yet, take the slow path until it comes round again
+            return consumeEach(consume);
+        }
+        TaskNode *first = tail;
+        if (first == &stub){
+            first = stub.next.load(std::memory_order_acquire);
+            if (first == nullptr) return 0;
+        }
+        stub.next.store(nullptr, std::memory_order_relaxed);
+        TaskNode *last = head.exchange(&stub, std::memory_order_seq_cst);
+        tail = &stub;
+        stubLinked = true;
+        std::size_t count = 0;
+        TaskNode *node = first;
+        for (;;){
+            TaskNode *next = nullptr;
+            if (node != last){
+                //a producer is between its exchange and its link
+                while ((next = node->next.load(std::memory_order_acquire)) == nullptr){
+                    std::this_thread::yield();
+                }
+            }
+            consume(node);
+            ++count;
+            if (node == last) break;
+            node = next;
+        }
+        countDequeued(count);
+        return count;
+    }
+
+    void blockingDequeue(TaskNode *&output);
+
+    //Safe to call from any thread
+    QueueStats stats() const;
+    
+    //Approximate number of queued nodes from the relaxed counters, safe to
+    //call from any thread
+    inline uint64_t depth() const {
+        uint64_t dequeued = dequeuedCount.load(std::memory_order_relaxed);
+        uint64_t enqueued = enqueuedCount.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+    
+    //A snapshot safe to call from any thread, a node whose producer is
+    //still linking it may briefly go unseen
+    inline bool empty() const {
+        return head.load(std::memory_order_seq_cst) == &stub;
+    }
+    
+    //Wakes a blocked reader so that it rechecks its predicate
+    inline void wakeReader(){
+        readerEvent.notify();
+    }
+
+    //Returns false if nothing arrived before the deadline
+    bool blockingDequeueUntil(TaskNode *&output, std::chrono::steady_clock::time_point deadline);
+    
+    //Also gives up once keepWaiting() no longer holds. It is checked after
+    //registering as a waiter, so a wakeReader that follows a change to what
+    //it checks can't be missed
+    template <typename Predicate>
+    bool blockingDequeueUntil(TaskNode *&output, std::chrono::steady_clock::time_point deadline, Predicate keepWaiting){
+        while (!dequeue(output)){
+            EventCount::Key key = readerEvent.prepareWait();
+            if (head.load(std::memory_order_seq_cst) != tail){
+                //a producer has swapped the head but not linked its node yet
+                std::this_thread::yield();
+            }
+            else if (!keepWaiting()){
+                return false;
+            }
+            else if (!readerEvent.waitUntil(key, deadline)){
+                return dequeue(output);
+            }
+        }
+        return true;
+    }
+
+    template <typename Rep, typename Period>
+    inline bool blockingDequeueFor(TaskNode *&output, const std::chrono::duration<Rep, Period> &timeout){
+        return blockingDequeueUntil(output, std::chrono::steady_clock::now() + 
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+    }
+
+private:
+    //seq_cst so that the exchange is ordered before the waiter check
+    inline void push(TaskNode *first, TaskNode *last){
+        TaskNode *prev = head.exchange(last, std::memory_order_seq_cst);
+        prev->next.store(first, std::memory_order_release);
+    }
+
+    inline void countEnqueued(uint64_t n){
+        uint64_t enqueued = enqueuedCount.fetch_add(n, std::memory_order_relaxed) + n;
+        raiseWatermark(highWatermark, enqueued, dequeuedCount.load(std::memory_order_relaxed));
+    }
+
+    //consumer only, so a plain load and store suffice
+    inline void countDequeued(uint64_t n){
+        dequeuedCount.store(dequeuedCount.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    template <typename F>
+    std::size_t consumeEach(F &consume){
+        std::size_t count = 0;
+        TaskNode *node;
+        while (dequeue(node)){
+            consume(node);
+            ++count;
+        }
+        return count;
+    }
+
+    //producers write the head line and only read the event count, the
+    //consumer owns the tail line. Whole lines of padding keep the two apart
+    //and off the neighbouring queues when queues sit side by side
+    char headPad[cacheLineSize];
+    std::atomic<TaskNode*> head;
+    std::atomic<uint64_t> enqueuedCount{0};
+    std::atomic<uint64_t> highWatermark{0};
+    EventCount readerEvent;
+    char tailPad[cacheLineSize];
+    TaskNode *tail;
+    std::atomic<uint64_t> dequeuedCount{0};
+    TaskNode stub;
+    //consumer only, true while the stub is queued
+    bool stubLinked{true};
+    char endPad[cacheLineSize];
+
+    TaskQueue(const TaskQueue&) = delete;
+    void operator=(const TaskQueue&) = delete;
+};
+
+}}
+
+#endif /* TASKQUEUE_H */
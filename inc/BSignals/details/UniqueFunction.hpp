@@ -0,0 +1,165 @@
+/*
+ * File:   UniqueFunction.hpp
+ * Move only, type erased callable with inline storage.
+ * Callables that fit in the inline buffer (and are nothrow move
+ * constructible) are stored in place, larger ones fall back to the heap.
+ * Unlike std::function there is no copy support and no RTTI.
+ */
+
+#ifndef UNIQUEFUNCTION_HPP
+#define UNIQUEFUNCTION_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+namespace BSignals{ namespace details{
+
+//Default inline storage, sized for a slot pointer plus a typical argument pack
+static const std::size_t defaultInlineSize = 64;
+
+template <typename Signature, std::size_t InlineSize = defaultInlineSize>
+class UniqueFunction;
+
+template <typename R, typename... A, std::size_t InlineSize>
+class UniqueFunction<R(A...), InlineSize>{
+public:
+    UniqueFunction() noexcept = default;
+
+    UniqueFunction(std::nullptr_t) noexcept {}
+
+    template <typename F, typename = typename std::enable_if<
+        !std::is_same<typename std::decay<F>::type, UniqueFunction>::value>::type>
+    UniqueFunction(F&& f){
+        typedef typename std::decay<F>::type Callable;
+        construct<Callable>(std::forward<F>(f), std::integral_constant<bool, fitsInline<Callable>()>());
+    }
+
+    UniqueFunction(UniqueFunction &&that) noexcept {
+        moveFrom(that);
+    }
+
+    UniqueFunction &operator=(UniqueFunction &&that) noexcept {
+        if (this != &that){
+            reset();
+            moveFrom(that);
+        }
+        return *this;
+    }
+
+    UniqueFunction &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    ~UniqueFunction(){
+        reset();
+    }
+
+    //Invocation is const to match std::function, the target itself may mutate
+    R operator()(A... args) const {
+        return ops->invoke(const_cast<void*>(static_cast<const void*>(&storage)), std::forward<A>(args)...);
+    }
+
+    explicit operator bool() const noexcept {
+        return ops != nullptr;
+    }
+
+    //True if the target is held in the inline buffer
+    bool isInline() const noexcept {
+        return ops != nullptr && ops->isInline;
+    }
+
+private:
+    struct Ops{
+        R (*invoke)(void*, A&&...);
+        void (*move)(void *dst, void *src) noexcept;
+        void (*destroy)(void*) noexcept;
+        bool isInline;
+    };
+
+    typedef typename std::aligned_storage<InlineSize, alignof(std::max_align_t)>::type Storage;
+
+    template <typename F>
+    static constexpr bool fitsInline(){
+        return sizeof(F) <= InlineSize && alignof(Storage) % alignof(F) == 0 &&
+            std::is_nothrow_move_constructible<F>::value;
+    }
+
+    template <typename F>
+    struct InlineOps{
+        static R invoke(void *s, A&&... args){
+            return (*static_cast<F*>(s))(std::forward<A>(args)...);
+        }
+        static void move(void *dst, void *src) noexcept {
+            new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        }
+        static void destroy(void *s) noexcept {
+            static_cast<F*>(s)->~F();
+        }
+        static const Ops ops;
+    };
+
+    template <typename F>
+    struct HeapOps{
+        static R invoke(void *s, A&&... args){
+            return (**static_cast<F**>(s))(std::forward<A>(args)...);
+        }
+        static void move(void *dst, void *src) noexcept {
+            *static_cast<F**>(dst) = *static_cast<F**>(src);
+        }
+        static void destroy(void *s) noexcept {
+            delete *static_cast<F**>(s);
+        }
+        static const Ops ops;
+    };
+
+    template <typename F, typename G>
+    void construct(G&& f, std::true_type){
+        new (&storage) F(std::forward<G>(f));
+        ops = &InlineOps<F>::ops;
+    }
+
+    template <typename F, typename G>
+    void construct(G&& f, std::false_type){
+        *reinterpret_cast<F**>(&storage) = new F(std::forward<G>(f));
+        ops = &HeapOps<F>::ops;
+    }
+
+    void moveFrom(UniqueFunction &that) noexcept {
+        if (that.ops){
+            that.ops->move(&storage, &that.storage);
+            ops = that.ops;
+            that.ops = nullptr;
+        }
+    }
+
+    void reset() noexcept {
+        if (ops){
+            ops->destroy(&storage);
+            ops = nullptr;
+        }
+    }
+
+    const Ops *ops{nullptr};
+    Storage storage;
+
+    UniqueFunction(const UniqueFunction&) = delete;
+    void operator=(const UniqueFunction&) = delete;
+};
+
+template <typename R, typename... A, std::size_t InlineSize>
+template <typename F>
+const typename UniqueFunction<R(A...), InlineSize>::Ops UniqueFunction<R(A...), InlineSize>::InlineOps<F>::ops =
+    {&InlineOps<F>::invoke, &InlineOps<F>::move, &InlineOps<F>::destroy, true};
+
+template <typename R, typename... A, std::size_t InlineSize>
+template <typename F>
+const typename UniqueFunction<R(A...), InlineSize>::Ops UniqueFunction<R(A...), InlineSize>::HeapOps<F>::ops =
+    {&HeapOps<F>::invoke, &HeapOps<F>::move, &HeapOps<F>::destroy, false};
+
+}}
+
+#endif /* UNIQUEFUNCTION_HPP */
@@ -8,42 +8,94 @@
 #ifndef WHEEL_HPP
 #define WHEEL_HPP
 
-#include <vector>
+#include <memory>
 #include <atomic>
+#include <cstdint>
+#include <thread>
+#include <functional>
+#include "BSignals/details/CacheLine.h"
 
 namespace BSignals{ namespace details{
 
-//T must be default constructable
-template <class T, uint32_t N>
+//T must be default constructable, and padded to its own cache lines if
+//neighbouring spokes are written by different threads.
+//The number of spokes is fixed on construction, only the first size() of
+//them are handed out by getSpoke() and getLighterSpoke()
+template <class T>
 class Wheel{
 public:
+    explicit Wheel(uint32_t n)
+        : Wheel(n, n) {}
+    
+    Wheel(uint32_t active, uint32_t capacity)
+        : wheelymajig(new T[capacity]), nElems(active), nSpokes(capacity) {}
     
     T& getSpoke(){
         return wheelymajig[fetchWrapIncrement(currentElement)];
     }
     
+    //Any spoke, whether it is handed out or not
     T& getSpoke(uint32_t index){
         return wheelymajig[index];
     }
     
-    const uint32_t size(){
-        return nElems;
+    //Samples two distinct spokes at random and returns the one with the
+    //lower load(spoke), so that no shared counter is written
+    template <typename F>
+    T& getLighterSpoke(F load){
+        uint32_t n = size();
+        if (n == 1) return wheelymajig[0];
+        uint32_t first = nextRandom() % n;
+        uint32_t second = (first + 1 + nextRandom() % (n - 1)) % n;
+        T &a = wheelymajig[first];
+        T &b = wheelymajig[second];
+        return load(b) < load(a) ? b : a;
+    }
+    
+    uint32_t size() const {
+        return nElems.load(std::memory_order_acquire);
+    }
+    
+    uint32_t capacity() const {
+        return nSpokes;
+    }
+    
+    //Changes how many spokes are handed out, up to the capacity. A spoke
+    //picked just before it stops being handed out may still be returned
+    void resize(uint32_t n){
+        nElems.store(n, std::memory_order_release);
     }
 
 private:
+    //xorshift, seeded per thread so that producers don't sample in step
+    static uint32_t nextRandom(){
+        static thread_local uint32_t state = 
+            static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    
     uint32_t fetchWrapIncrement(std::atomic<uint32_t> &shared){
         uint32_t oldValue = shared.load();
-        uint32_t newValue;
+        uint32_t newValue, n;
         do {
-            newValue = (oldValue+1)%nElems;
+            n = size();
+            newValue = (oldValue+1)%n;
         } while (!shared.compare_exchange_weak(oldValue, newValue));
-        return oldValue;
+        //the wheel may have shrunk since the counter was advanced
+        return oldValue%n;
     }
+    //every producer bumps the counter, so it gets a line to itself rather
+    //than sharing one with the spoke pointer
+    char counterPad[cacheLineSize];
     std::atomic<uint32_t> currentElement{0};
-    std::array<T, N> wheelymajig;
-    const uint32_t nElems{N};
+    char spokePad[cacheLineSize];
+    std::unique_ptr<T[]> wheelymajig;
+    std::atomic<uint32_t> nElems;
+    const uint32_t nSpokes;
 };    
 }}
 
 #endif /* WHEEL_HPP */
-
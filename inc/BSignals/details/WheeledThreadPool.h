@@ -9,44 +9,218 @@
 #include <atomic>
 #include <functional>
 #include <thread>
+#include <chrono>
 #include <mutex>
+#include <type_traits>
+#include <cstdint>
 #include "BSignals/details/SafeQueue.hpp"
+#include "BSignals/details/ParamTraits.hpp"
 #include "BSignals/details/Wheel.hpp"
-#include "BSignals/details/MPSCQueue.hpp"
+#include "BSignals/details/TaskQueue.h"
+#include "BSignals/details/WorkStealingDeque.hpp"
+#include "BSignals/details/CacheLine.h"
 
 #ifndef WHEELEDTHREADPOOL_H
 #define WHEELEDTHREADPOOL_H
 
 namespace BSignals{ namespace details{
 
+//How tasks injected from outside the pool pick a thread's spoke
+enum class SpokeSelection{
+    ROUND_ROBIN,            //each spoke in turn
+    LEAST_LOADED_OF_TWO     //the less loaded of two spokes sampled at random
+};
+
+//A pool of worker threads that thread pooled slots queue their emissions on.
+//Thread pooled slots share the global pool unless connected to a pool of
+//their own. A pool starts when the first slot is connected to it
 class WheeledThreadPool {
 public:
+    //Sized from the environment or the number of CPUs unless configured
+    //before it starts
+    WheeledThreadPool();
+    
+    //An elastic pool when minThreads is below maxThreads, 0 for both uses the
+    //default size
+    WheeledThreadPool(uint32_t minThreads, uint32_t maxThreads, 
+        std::chrono::steady_clock::duration idleTimeout, SpokeSelection selection);
+    
+    //Stops the threads, tasks still queued are discarded
+    ~WheeledThreadPool();
     
-    template <typename... Args>
-    static void run(const std::function<void(Args...)> &task, const Args &... p){
-        run([task, p...](){task(p...);});
+    //The pool thread pooled slots use by default
+    static WheeledThreadPool &global();
+    
+    //The task and its arguments are moved (or copied from lvalues) into a
+    //pooled task node once, then moved out into the call
+    template <typename F, typename... P, typename = typename std::enable_if<
+        !std::is_convertible<F, BSignals::details::TaskNode*>::value &&
+        !std::is_same<typename std::decay<F>::type, BSignals::details::TaskQueue::Chain>::value>::type>
+    void run(F &&task, P &&... p){
+        run(makeTask([task = typename std::decay<F>::type(std::forward<F>(task)), 
+                args = BoundArgs<P...>(std::forward<P>(p)...)]() mutable {
+            invokeMoved(task, args);
+        }));
     }
     
-    static void run(const std::function<void()> task);
+    //Takes ownership of the task, starts the pool if it is not running.
+    //Tasks from outside the pool are injected through a spoke, tasks queued
+    //by one of its own threads go on that thread's own deque
+    void run(BSignals::details::TaskNode *task);
+    
+    typedef BSignals::details::TaskQueue::Chain TaskChain;
+    
+    //The whole run of tasks is injected through a single spoke
+    void run(TaskChain &&tasks);
     
     //only invoke start up if a thread pooled slot has been connected
-    static void startup();
+    void startup();
+    
+    //Sets the number of pool threads, 0 restores the default. Only takes
+    //effect before the pool starts, returns false once it is running
+    bool configure(uint32_t threads);
+    
+    //Makes the pool elastic. It starts with minThreads, adds a thread when
+    //an injected task finds every thread busy with a backlog behind it, up
+    //to maxThreads, and retires threads idle for longer than idleTimeout
+    //down to minThreads. Returns false if the pool is running or the bounds
+    //are invalid (minThreads must be at least 1 and at most maxThreads)
+    bool configure(uint32_t minThreads, uint32_t maxThreads, 
+        std::chrono::steady_clock::duration idleTimeout);
+    
+    //The number of threads the pool runs with, or will start with.
+    //An explicit configure wins over the environment variable, which wins
+    //over the number of CPUs this process may use
+    uint32_t getPoolSize() const;
+    
+    //Can be changed at any time, the default is LEAST_LOADED_OF_TWO
+    void setSpokeSelection(SpokeSelection selection);
+    
+    SpokeSelection getSpokeSelection() const;
+    
+    //Environment variable that overrides the default pool size
+    static const char *const poolSizeVariable;
     
     static std::chrono::duration<double> getMaxWait();
+    
+    //Counters of each spoke's queue, in spoke order. An elastic pool has a
+    //spoke for each of its maximum number of threads
+    std::vector<BSignals::details::QueueStats> queueStats() const;
+    
+    //How long a listener stays parked without work before it wakes to
+    //recheck whether it is still needed
+    static std::chrono::steady_clock::duration getMaxIdle();
 private:
-    static void queueListener(uint32_t index);
+    //A pool thread's injection spoke, which any idle thread may claim and
+    //drain, and its deque, which other threads steal from
+    struct Worker{
+        BSignals::details::TaskQueue spoke;
+        BSignals::details::WorkStealingDeque<BSignals::details::TaskNode*> deque;
+        //held while draining the spoke, or while parked on it
+        std::atomic<bool> claimed{false};
+        std::atomic<bool> parked{false};
+        //set while running a task, work injected meanwhile needs a thief
+        std::atomic<bool> busy{false};
+        //whether a thread runs this worker, a retired worker's spoke is
+        //no longer handed out but may still be drained by other workers
+        std::atomic<bool> active{false};
+        char pad[cacheLineSize];
+        
+        //queued, stolen or not, plus the task being run
+        uint64_t load() const {
+            return spoke.depth() + deque.size() + busy.load(std::memory_order_relaxed);
+        }
+        
+        bool tryClaim(){
+            return !claimed.load(std::memory_order_relaxed) && 
+                !claimed.exchange(true, std::memory_order_acquire);
+        }
+        
+        void release(){
+            claimed.store(false, std::memory_order_release);
+        }
+    };
+    
+    typedef BSignals::details::Wheel<Worker> Spokes;
+    
+    void queueListener(Spokes &spokes, uint32_t index);
+    
+    //Takes work from the worker's own deque, then its own spoke, then from
+    //the other workers, starting at a random one
+    bool findTask(Spokes &spokes, Worker &self, uint32_t victim, BSignals::details::TaskNode *&task);
+    
+    //Moves a claimed spoke's backlog onto the worker's deque, oldest at the
+    //bottom so that it is popped first, and hands back the oldest
+    static bool drainSpoke(Worker &self, Worker &from, BSignals::details::TaskNode *&task);
+    
+    //Wakes a parked worker, if there is one, to steal surplus work
+    static void wakeThief(Spokes &spokes, uint32_t start);
+    
+    //Whether any spoke or deque looks non-empty
+    static bool hasWork(Spokes &spokes);
+    
+    //Called after a task has been injected through the target's spoke
+    void injected(Spokes &spokes, Worker &target);
+    
+    //Adds a thread to an elastic pool unless it is at its maximum. Emitters
+    //give up rather than wait if the pool is being changed, pool threads
+    //wait so that a thread just added can ask for the next one
+    void grow(Spokes &spokes, bool wait);
+    
+    //Retires the worker if it is the last one handed out and the pool is
+    //above its minimum, returns whether it was retired
+    bool retire(Spokes &spokes, uint32_t index);
+    
+    //Called with tpLock held
+    void spawnWorker(Spokes &spokes, uint32_t index);
+    
+    //The spokes of a running pool, starting it first if need be
+    inline Spokes &runningSpokes(){
+        Spokes *spokes = threadPooledFunctions.load(std::memory_order_acquire);
+        if (spokes == nullptr){
+            startup();
+            spokes = threadPooledFunctions.load(std::memory_order_acquire);
+        }
+        return *spokes;
+    }
+    
+    static uint32_t defaultPoolSize();
+    
+    //The worker whose spoke an external task is injected through
+    inline Worker &injectionTarget(Spokes &spokes){
+        if (spokeSelection.load(std::memory_order_relaxed) == SpokeSelection::ROUND_ROBIN){
+            return spokes.getSpoke();
+        }
+        return spokes.getLighterSpoke([](const Worker &worker){ return worker.load(); });
+    }
+    
     static class _init {
     public:
         _init(); 
-        ~_init(); 
     } _initializer;
     
-    static const uint32_t nThreads{32};
+    //0 for the default size
+    uint32_t configuredMinThreads{0};
+    uint32_t configuredMaxThreads{0};
+    uint32_t minThreads{0};
+    std::chrono::steady_clock::duration idleTimeout;
+    //waiting tasks behind a busy worker that make an elastic pool grow
+    static const uint64_t growBacklog;
     static std::chrono::duration<double> maxWait;
-    static std::mutex tpLock;
-    static bool isStarted;
-    static BSignals::details::Wheel<BSignals::details::MPSCQueue<std::function<void()>>, BSignals::details::WheeledThreadPool::nThreads> threadPooledFunctions;
-    static std::vector<std::thread> queueMonitors;
+    static const std::chrono::steady_clock::duration maxIdle;
+    mutable std::mutex tpLock;
+    std::atomic<bool> isStarted{false};
+    std::atomic<uint32_t> nParked{0};
+    std::atomic<SpokeSelection> spokeSelection;
+    //the pool and worker run by the calling thread, if it is a pool thread
+    static thread_local WheeledThreadPool *currentPool;
+    static thread_local Worker *currentWorker;
+    //created on start up once the pool size is known
+    std::atomic<Spokes*> threadPooledFunctions{nullptr};
+    std::vector<std::thread> queueMonitors;
+    
+    WheeledThreadPool(const WheeledThreadPool&) = delete;
+    void operator=(const WheeledThreadPool&) = delete;
 };
 }}
 
@@ -0,0 +1,147 @@
+/*
+ * File:   WorkStealingDeque.hpp
+ * Chase-Lev work stealing deque
+ * Based on "Dynamic Circular Work-Stealing Deque" (Chase, Lev 2005) with the
+ * memory orderings of "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (Le, Pop, Cohen, Zappa Nardelli 2013).
+ * The owning thread pushes and pops at the bottom without a CAS unless it is
+ * taking the last element, any other thread steals from the top with a CAS.
+ * The ring doubles when full. Replaced rings are kept until the deque is
+ * destroyed, as a thief may still be reading from one.
+ * T must be trivially copyable, the deque holds task pointers.
+ */
+
+#ifndef WORKSTEALINGDEQUE_HPP
+#define WORKSTEALINGDEQUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <type_traits>
+
+#include "BSignals/details/CacheLine.h"
+
+namespace BSignals{ namespace details{
+
+template <typename T>
+class WorkStealingDeque{
+    static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque elements must be trivially copyable");
+public:
+    explicit WorkStealingDeque(uint32_t minCapacity = 256){
+        std::size_t size = 2;
+        while (size < minCapacity) size <<= 1;
+        rings.emplace_back(new Ring(size));
+        ring.store(rings.back().get(), std::memory_order_relaxed);
+    }
+
+    //Owner only
+    void push(T item){
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Ring *r = ring.load(std::memory_order_relaxed);
+        if (b - t > r->mask){
+            r = grow(r, t, b);
+        }
+        r->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    //Owner only, takes the most recently pushed element
+    bool pop(T &output){
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Ring *r = ring.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b){
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        output = r->get(b);
+        if (t == b){
+            //the last element, race any thief for it
+            bool won = top.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    //Any thread, takes the least recently pushed element. Fails if the deque
+    //looks empty or another thread took the element first
+    bool steal(T &output){
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return false;
+        Ring *r = ring.load(std::memory_order_acquire);
+        T item = r->get(t);
+        if (!top.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed)){
+            return false;
+        }
+        output = item;
+        return true;
+    }
+
+    //A snapshot safe to call from any thread
+    bool empty() const {
+        int64_t t = top.load(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_seq_cst);
+        return t >= b;
+    }
+
+    //Approximate number of elements, safe to call from any thread
+    std::size_t size() const {
+        int64_t t = top.load(std::memory_order_relaxed);
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+private:
+    struct Ring{
+        explicit Ring(std::size_t size)
+            : mask(size - 1), items(new std::atomic<T>[size]) {}
+
+        inline T get(int64_t index) const {
+            return items[index & mask].load(std::memory_order_relaxed);
+        }
+
+        inline void put(int64_t index, T item){
+            items[index & mask].store(item, std::memory_order_relaxed);
+        }
+
+        const int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+    Ring *grow(Ring *old, int64_t t, int64_t b){
+        Ring *bigger = new Ring(2*(old->mask + 1));
+        for (int64_t i=t; i<b; ++i){
+            bigger->put(i, old->get(i));
+        }
+        rings.emplace_back(bigger);
+        ring.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    //thieves write the top, the owner the bottom
+    char topPad[cacheLineSize];
+    std::atomic<int64_t> top{0};
+    char bottomPad[cacheLineSize];
+    std::atomic<int64_t> bottom{0};
+    std::atomic<Ring*> ring;
+    //owner only
+    std::vector<std::unique_ptr<Ring>> rings;
+    char endPad[cacheLineSize];
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    void operator=(const WorkStealingDeque&) = delete;
+};
+
+}}
+
+#endif /* WORKSTEALINGDEQUE_HPP */
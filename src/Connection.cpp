@@ -0,0 +1,56 @@
+#include "BSignals/Connection.h"
+
+using BSignals::Connection;
+using BSignals::ScopedConnection;
+using BSignals::ConnectionBlocker;
+using BSignals::details::SlotLink;
+
+Connection::Connection(std::weak_ptr<SlotLink> slotLink)
+    : link(std::move(slotLink)) {}
+
+void Connection::disconnect() const {
+    auto slot = link.lock();
+    if (slot && slot->isConnected()){
+        slot->disconnect();
+    }
+}
+
+bool Connection::connected() const {
+    auto slot = link.lock();
+    return slot && slot->isConnected();
+}
+
+int Connection::id() const {
+    auto slot = link.lock();
+    return (slot && slot->isConnected()) ? (int)slot->id : -1;
+}
+
+ScopedConnection::ScopedConnection(Connection &&connection)
+    : Connection(std::move(connection)) {}
+
+ScopedConnection &ScopedConnection::operator=(ScopedConnection &&that) {
+    if (this != &that){
+        disconnect();
+        Connection::operator=(std::move(that));
+    }
+    return *this;
+}
+
+ScopedConnection::~ScopedConnection() {
+    disconnect();
+}
+
+Connection ScopedConnection::release() {
+    Connection connection(std::move(*this));
+    Connection::operator=(Connection());
+    return connection;
+}
+
+ConnectionBlocker::ConnectionBlocker(const Connection &connection)
+    : link(connection.link.lock()) {
+    if (link) link->state.fetch_add(1, std::memory_order_relaxed);
+}
+
+ConnectionBlocker::~ConnectionBlocker() {
+    if (link) link->state.fetch_sub(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,28 @@
+#include "BSignals/ThreadPool.h"
+#include <algorithm>
+
+using BSignals::ThreadPool;
+using BSignals::SpokeSelection;
+
+ThreadPool::ThreadPool(uint32_t threads, SpokeSelection selection)
+    : pool(threads, threads, BSignals::details::WheeledThreadPool::getMaxIdle(),
+        (BSignals::details::SpokeSelection)selection) {}
+
+ThreadPool::ThreadPool(uint32_t minThreads, uint32_t maxThreads,
+        std::chrono::steady_clock::duration idleTimeout, SpokeSelection selection)
+    : pool(std::max(minThreads, 1u), std::max({minThreads, maxThreads, 1u}), idleTimeout,
+        (BSignals::details::SpokeSelection)selection) {}
+
+ThreadPool::~ThreadPool() {}
+
+uint32_t ThreadPool::size() const {
+    return pool.getPoolSize();
+}
+
+void ThreadPool::setSelection(SpokeSelection selection) {
+    pool.setSpokeSelection((BSignals::details::SpokeSelection)selection);
+}
+
+std::vector<BSignals::details::QueueStats> ThreadPool::stats() const {
+    return pool.queueStats();
+}
@@ -0,0 +1,74 @@
+#include "BSignals/details/EpochReclaimer.h"
+#include <limits>
+
+using BSignals::details::EpochReclaimer;
+
+std::atomic<uint64_t> EpochReclaimer::globalEpoch{1};
+std::atomic<EpochReclaimer::ReaderRecord*> EpochReclaimer::readers{nullptr};
+thread_local EpochReclaimer::ReaderState EpochReclaimer::readerState{nullptr, 0};
+
+namespace {
+//Hands a thread's reader record back to the free pool when the thread exits
+struct ReaderRelease{
+    std::atomic<bool> *inUse{nullptr};
+    ~ReaderRelease(){
+        if (inUse) inUse->store(false, std::memory_order_release);
+    }
+};
+thread_local ReaderRelease readerRelease;
+}
+
+EpochReclaimer::~EpochReclaimer() {
+    //owner guarantees no emission is concurrent with destruction
+    for (auto &r : retired){
+        r.deleter(r.ptr);
+    }
+}
+
+void EpochReclaimer::reclaim() {
+    if (retired.empty()) return;
+    uint64_t oldest = oldestActiveEpoch();
+    auto keep = retired.begin();
+    for (auto it = retired.begin(); it != retired.end(); ++it){
+        if (it->epoch < oldest){
+            it->deleter(it->ptr);
+        }
+        else{
+            *keep++ = *it;
+        }
+    }
+    retired.erase(keep, retired.end());
+}
+
+EpochReclaimer::ReaderRecord *EpochReclaimer::registerReader() {
+    //reuse the record of an exited thread if possible
+    for (ReaderRecord *r = readers.load(std::memory_order_acquire); r; r = r->next){
+        bool expected = false;
+        if (!r->inUse.load(std::memory_order_relaxed) && 
+                r->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)){
+            readerRelease.inUse = &r->inUse;
+            return r;
+        }
+    }
+    ReaderRecord *r = new ReaderRecord;
+    ReaderRecord *head = readers.load(std::memory_order_relaxed);
+    do {
+        r->next = head;
+    } while (!readers.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+    readerRelease.inUse = &r->inUse;
+    return r;
+}
+
+uint64_t EpochReclaimer::advanceEpoch() {
+    //readers entering at the returned epoch may still hold the unlinked object
+    return globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+}
+
+uint64_t EpochReclaimer::oldestActiveEpoch() {
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (ReaderRecord *r = readers.load(std::memory_order_acquire); r; r = r->next){
+        uint64_t e = r->epoch.load(std::memory_order_seq_cst);
+        if (e != 0 && e < oldest) oldest = e;
+    }
+    return oldest;
+}
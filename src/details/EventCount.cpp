@@ -0,0 +1,91 @@
+#include "BSignals/details/EventCount.h"
+
+#ifdef LINUX
+#include <climits>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+using BSignals::details::EventCount;
+
+#ifdef LINUX
+namespace {
+    //The futex word is the state itself, waits return early if it has moved on
+    inline void futexWait(std::atomic<uint32_t> &word, uint32_t expected){
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    }
+
+    //Absolute CLOCK_MONOTONIC deadline, which is what steady_clock reads.
+    //Returns false once the deadline has passed
+    inline bool futexWaitUntil(std::atomic<uint32_t> &word, uint32_t expected, 
+            std::chrono::steady_clock::time_point deadline){
+        auto sinceEpoch = deadline.time_since_epoch();
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+        struct timespec ts;
+        ts.tv_sec = seconds.count();
+        ts.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch - seconds).count();
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_BITSET_PRIVATE, expected, 
+            &ts, nullptr, FUTEX_BITSET_MATCH_ANY) == 0 || errno != ETIMEDOUT;
+    }
+
+    inline void futexWakeAll(std::atomic<uint32_t> &word){
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+}
+#endif
+
+EventCount::Key EventCount::prepareWait() {
+    return state.fetch_or(waitingBit, std::memory_order_seq_cst) | waitingBit;
+}
+
+void EventCount::wait(Key key) {
+#ifdef LINUX
+    while (state.load(std::memory_order_acquire) == key){
+        futexWait(state, key);
+    }
+#else
+    std::unique_lock<std::mutex> lock(mutex);
+    while (state.load(std::memory_order_acquire) == key){
+        cv.wait(lock);
+    }
+#endif
+}
+
+bool EventCount::waitUntil(Key key, std::chrono::steady_clock::time_point deadline) {
+#ifdef LINUX
+    while (state.load(std::memory_order_acquire) == key){
+        if (!futexWaitUntil(state, key, deadline)){
+            return state.load(std::memory_order_acquire) != key;
+        }
+    }
+#else
+    std::unique_lock<std::mutex> lock(mutex);
+    while (state.load(std::memory_order_acquire) == key){
+        if (cv.wait_until(lock, deadline) == std::cv_status::timeout){
+            return state.load(std::memory_order_acquire) != key;
+        }
+    }
+#endif
+    return true;
+}
+
+void EventCount::notifyWaiters() {
+#ifndef LINUX
+    std::unique_lock<std::mutex> lock(mutex);
+#endif
+    //advance the epoch and clear the bit, only one notifier gets to wake
+    uint32_t current = state.load(std::memory_order_relaxed);
+    do {
+        if (!(current & waitingBit)) return;
+    } while (!state.compare_exchange_weak(current, (current + 2) & ~waitingBit, 
+        std::memory_order_seq_cst, std::memory_order_relaxed));
+#ifdef LINUX
+    futexWakeAll(state);
+#else
+    lock.unlock();
+    cv.notify_all();
+#endif
+}
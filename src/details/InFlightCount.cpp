@@ -0,0 +1,20 @@
+#include "BSignals/details/InFlightCount.h"
+
+using BSignals::details::InFlightCount;
+
+InFlightCount::InFlightCount()
+    : drainedFuture(drained.get_future().share()) {}
+
+std::shared_future<void> InFlightCount::close() {
+    uint32_t state = count.fetch_or(closedBit, std::memory_order_acq_rel);
+    if (state == 0) finish();
+    return drainedFuture;
+}
+
+bool InFlightCount::isDrained() const {
+    return drainedFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void InFlightCount::finish() {
+    drained.set_value();
+}
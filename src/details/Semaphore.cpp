@@ -9,7 +9,7 @@ Semaphore::~Semaphore() {}
 
 void Semaphore::acquire() {
     std::unique_lock<std::mutex> lock(semMutex);
-    while (semCounter < 0){
+    while (semCounter == 0){
         semCV.wait(lock);
     }
     semCounter--;
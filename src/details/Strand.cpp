@@ -0,0 +1,191 @@
+#include "BSignals/details/Strand.h"
+#include "BSignals/details/WheeledThreadPool.h"
+#include <cassert>
+
+using BSignals::details::Strand;
+using BSignals::details::TaskNode;
+using BSignals::details::WheeledThreadPool;
+using BSignals::details::BoundedQueue;
+using BSignals::details::SPSCQueue;
+using BSignals::details::OverflowPolicy;
+
+Strand::Strand()
+    : drainedFuture(drained.get_future().share()), 
+      thread([this](){ queueListener(queue); }) {}
+
+Strand::Strand(uint32_t capacity, OverflowPolicy overflowPolicy, bool singleProducer)
+    : policy(overflowPolicy), drainedFuture(drained.get_future().share()) {
+    assert(!(singleProducer && policy == OverflowPolicy::DROP_OLDEST) && "DROP_OLDEST needs a multi-producer ring");
+    if (singleProducer){
+        single.reset(new SPSCQueue<TaskNode*>(capacity));
+        thread = std::thread([this](){ queueListener(*single); });
+    }
+    else{
+        bounded.reset(new BoundedQueue<TaskNode*>(capacity));
+        thread = std::thread([this](){ queueListener(*bounded); });
+    }
+}
+
+Strand::~Strand() {
+    stop();
+    //bounded rings hold plain pointers, tasks left by emitters that raced the stop
+    TaskNode *task;
+    while (bounded && bounded->dequeue(task)){
+        if (!task->isMarker()) task->discard();
+    }
+    while (single && single->dequeue(task)){
+        task->discard();
+    }
+}
+
+std::shared_future<void> Strand::stopAsync() {
+    if (open.exchange(false)){
+        //a single producer ring takes no marker from a second thread, its
+        //listener stops once it finds the ring empty and the strand closed
+        if (single) single->wakeReader();
+        //the listener keeps draining, so a full ring always makes room
+        else if (bounded) bounded->blockingEnqueue(&stopMarker, [](){ return true; });
+        else queue.enqueue(&stopMarker);
+    }
+    return drainedFuture;
+}
+
+bool Strand::enqueue(TaskChain &&tasks) {
+    if (!open.load(std::memory_order_relaxed)) return true;
+    if (!bounded && !single){
+        queue.enqueue(std::move(tasks));
+        return true;
+    }
+    bool accepted = true;
+    TaskNode *task;
+    while (tasks.pop(task)){
+        accepted &= enqueue(task);
+    }
+    return accepted;
+}
+
+bool Strand::enqueueBounded(TaskNode *task) {
+    bool accepted = true;
+    switch (policy){
+        case (OverflowPolicy::BLOCK):
+            //emitters stuck behind a strand that is being stopped give up
+            if (bounded->blockingEnqueue(std::move(task), [this](){ return open.load(std::memory_order_seq_cst); })) return true;
+            break;
+        case (OverflowPolicy::DROP_NEWEST):
+            if (bounded->tryEnqueue(std::move(task))) return true;
+            break;
+        case (OverflowPolicy::DROP_OLDEST):
+            while (!bounded->tryEnqueue(std::move(task))){
+                TaskNode *oldest;
+                if (!bounded->dequeue(oldest)) continue;
+                if (oldest->isMarker()){
+                    //the stop marker must stay last, the strand is closing anyway
+                    bounded->blockingEnqueue(std::move(oldest), [](){ return true; });
+                    task->discard();
+                    return true;
+                }
+                oldest->discard();
+            }
+            return true;
+        case (OverflowPolicy::FAIL_FAST):
+            if (bounded->tryEnqueue(std::move(task))) return true;
+            accepted = false;
+            break;
+    }
+    task->discard();
+    return accepted;
+}
+
+bool Strand::enqueueSingle(TaskNode *task) {
+    bool accepted = true;
+    switch (policy){
+        case (OverflowPolicy::BLOCK):
+            if (single->blockingEnqueue(std::move(task), [this](){ return open.load(std::memory_order_seq_cst); })) return true;
+            break;
+        case (OverflowPolicy::FAIL_FAST):
+            accepted = false;
+            break;
+        default:
+            break;
+    }
+    task->discard();
+    return accepted;
+}
+
+BSignals::details::QueueStats Strand::stats() const {
+    if (single) return single->stats();
+    if (bounded) return bounded->stats();
+    return queue.stats();
+}
+
+bool Strand::isDrained() const {
+    return drainedFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void Strand::stop() {
+    stopAsync();
+    if (thread.joinable()){
+        thread.join();
+    }
+}
+
+namespace {
+    //Runs a dequeued task, whose node is released straight away so that
+    //whatever it captured is not held while waiting. False on the stop marker
+    inline bool runTask(TaskNode *task){
+        if (task->isMarker()) return false;
+        task->run();
+        return true;
+    }
+    
+    //Blocks for the next task, false if none arrived before the deadline
+    template <typename Q>
+    inline bool waitForTask(Q &taskQueue, TaskNode *&task, const std::atomic<bool>&, 
+            std::chrono::steady_clock::time_point deadline){
+        return taskQueue.blockingDequeueUntil(task, deadline);
+    }
+    
+    //A single producer ring carries no stop marker, closing the strand
+    //wakes the listener instead
+    inline bool waitForTask(SPSCQueue<TaskNode*> &taskQueue, TaskNode *&task, const std::atomic<bool> &open,
+            std::chrono::steady_clock::time_point deadline){
+        return taskQueue.blockingDequeueUntil(task, deadline, [&open](){ return open.load(std::memory_order_seq_cst); });
+    }
+}
+
+template <typename Q>
+void Strand::queueListener(Q &taskQueue) {
+    TaskNode *task;
+    auto maxWait = WheeledThreadPool::getMaxWait();
+    auto maxIdle = WheeledThreadPool::getMaxIdle();
+    std::chrono::duration<double> waitTime = std::chrono::nanoseconds(1);
+    bool running = true;
+    //tasks behind the stop marker come from emitters that raced the stop,
+    //they are discarded, which also releases any emitter waiting for room
+    auto consume = [&running](TaskNode *task){
+        if (running) running = runTask(task);
+        else if (!task->isMarker()) task->discard();
+    };
+    while (running){
+        //a burst is taken off the queue in one go
+        if (taskQueue.consumeAll(consume)){
+            waitTime = std::chrono::nanoseconds(1);
+        }
+        else if (waitTime <= maxWait){
+            std::this_thread::sleep_for(waitTime);
+            waitTime*=2;
+        }
+        //parked with a deadline, an idle listener wakes to recheck the strand
+        if (running && waitTime > maxWait){
+            if (waitForTask(taskQueue, task, open, std::chrono::steady_clock::now() + maxIdle)){
+                consume(task);
+                waitTime = std::chrono::nanoseconds(1);
+            }
+            else if (!open.load(std::memory_order_seq_cst)){
+                running = false;
+            }
+        }
+    }
+    while (taskQueue.consumeAll(consume)) {}
+    drained.set_value();
+}
@@ -0,0 +1,62 @@
+#include "BSignals/details/TaskQueue.h"
+#include <thread>
+
+using BSignals::details::TaskQueue;
+using BSignals::details::TaskNode;
+using BSignals::details::EventCount;
+
+TaskQueue::TaskQueue()
+    : head(&stub), tail(&stub) {}
+
+TaskQueue::~TaskQueue() {
+    TaskNode *node;
+    while (dequeue(node)){
+        if (!node->isMarker()) node->discard();
+    }
+}
+
+void TaskQueue::enqueue(Chain &&chain) {
+    if (chain.first == nullptr) return;
+    countEnqueued(chain.count);
+    push(chain.first, chain.last);
+    chain.first = chain.last = nullptr;
+    chain.count = 0;
+    readerEvent.notify();
+}
+
+void TaskQueue::blockingDequeue(TaskNode *&output) {
+    while (!dequeue(output)){
+        EventCount::Key key = readerEvent.prepareWait();
+        if (head.load(std::memory_order_seq_cst) != tail){
+            //a producer has swapped the head but not linked its node yet
+            std::this_thread::yield();
+        }
+        else{
+            readerEvent.wait(key);
+        }
+    }
+}
+
+bool TaskQueue::blockingDequeueUntil(TaskNode *&output, std::chrono::steady_clock::time_point deadline) {
+    return blockingDequeueUntil(output, deadline, [](){ return true; });
+}
+
+BSignals::details::QueueStats TaskQueue::stats() const {
+    uint64_t dequeued = dequeuedCount.load(std::memory_order_seq_cst);
+    return makeQueueStats(enqueuedCount.load(std::memory_order_seq_cst), dequeued, 
+        highWatermark.load(std::memory_order_relaxed));
+}
+
+TaskQueue::Chain::~Chain() {
+    TaskNode *node;
+    while (pop(node)) node->discard();
+}
+
+bool TaskQueue::Chain::pop(TaskNode *&output) {
+    if (first == nullptr) return false;
+    output = first;
+    first = first->next.load(std::memory_order_relaxed);
+    if (first == nullptr) last = nullptr;
+    --count;
+    return true;
+}
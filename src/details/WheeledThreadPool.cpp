@@ -1,84 +1,410 @@
 #include "BSignals/details/WheeledThreadPool.h"
 #include "BSignals/details/BasicTimer.h"
 #include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <random>
+
+#ifdef LINUX
+#include <sched.h>
+#endif
 
 using std::mutex;
 using std::lock_guard;
 using std::atomic;
 using std::vector;
 using BSignals::details::Wheel;
-using BSignals::details::MPSCQueue;
 using BSignals::details::SafeQueue;
 using BSignals::details::WheeledThreadPool;
 using BSignals::details::BasicTimer;
+using BSignals::details::TaskQueue;
+using BSignals::details::TaskNode;
+
+namespace {
+
+//the pool's size before it was configurable, for when the CPUs can't be counted
+const uint32_t fallbackPoolSize = 32;
+
+//Parses a positive count, 0 if the text isn't one
+uint32_t parseCount(const std::string &text){
+    char *end = nullptr;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str() || *end != '\0' || value > UINT32_MAX) return 0;
+    return static_cast<uint32_t>(value);
+}
 
-std::mutex WheeledThreadPool::tpLock;
-bool WheeledThreadPool::isStarted = false;
+//CPUs worth of time the cgroup CPU quota allows, rounded up, 0 if unlimited
+uint32_t cgroupCpuLimit(){
+#ifdef LINUX
+    std::string quota, period;
+    //cgroup v2 holds "<quota> <period>", the quota being "max" if unlimited
+    std::ifstream v2("/sys/fs/cgroup/cpu.max");
+    if (!(v2 >> quota >> period)){
+        //cgroup v1 marks an unlimited quota with -1, which fails to parse
+        std::ifstream v1Quota("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+        std::ifstream v1Period("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+        if (!(v1Quota >> quota) || !(v1Period >> period)) return 0;
+    }
+    uint64_t q = parseCount(quota), p = parseCount(period);
+    if (q == 0 || p == 0) return 0;
+    return static_cast<uint32_t>((q + p - 1)/p);
+#else
+    return 0;
+#endif
+}
+
+//CPUs this process may be scheduled on
+uint32_t availableCpus(){
+#ifdef LINUX
+    cpu_set_t cpus;
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0 && CPU_COUNT(&cpus) > 0){
+        return CPU_COUNT(&cpus);
+    }
+#endif
+    return std::thread::hardware_concurrency();
+}
+
+}
+
+thread_local WheeledThreadPool *WheeledThreadPool::currentPool = nullptr;
+thread_local WheeledThreadPool::Worker *WheeledThreadPool::currentWorker = nullptr;
+const uint64_t WheeledThreadPool::growBacklog = 2;
+const char *const WheeledThreadPool::poolSizeVariable = "BSIGNALS_POOL_THREADS";
 std::chrono::duration<double> WheeledThreadPool::maxWait;
-Wheel<MPSCQueue<std::function<void()>>, BSignals::details::WheeledThreadPool::nThreads> WheeledThreadPool::threadPooledFunctions {};
-std::vector<std::thread> WheeledThreadPool::queueMonitors;
+const std::chrono::steady_clock::duration WheeledThreadPool::maxIdle = std::chrono::seconds(1);
 
 WheeledThreadPool::_init WheeledThreadPool::_initializer;
 
 WheeledThreadPool::_init::_init(){
     //make a conservative estimate of when blocking will
-    //be faster than spinning
+    //be faster than spinning, on the queue the pool threads block on
     BasicTimer bt;
-    MPSCQueue<int> tq;
-    tq.enqueue(0);
-    int x;
+    TaskQueue tq;
+    tq.enqueue(makeTask([](){}));
+    TaskNode *x;
     bt.start();
     tq.blockingDequeue(x);
     bt.stop();
+    x->discard();
     maxWait = bt.getElapsedDuration()*2;
 }
 
-WheeledThreadPool::_init::~_init() {
-    std::lock_guard<mutex> lock(tpLock);
-    isStarted = false;
-    for (uint32_t i=0; i<nThreads; i++){
-        threadPooledFunctions.getSpoke(i).enqueue(nullptr);
+WheeledThreadPool::WheeledThreadPool()
+    : idleTimeout(maxIdle), spokeSelection(SpokeSelection::LEAST_LOADED_OF_TWO) {}
+
+WheeledThreadPool::WheeledThreadPool(uint32_t minThreads, uint32_t maxThreads, 
+        std::chrono::steady_clock::duration idleTimeout, SpokeSelection selection)
+    : configuredMinThreads(minThreads), configuredMaxThreads(maxThreads), 
+      idleTimeout(idleTimeout), spokeSelection(selection) {}
+
+WheeledThreadPool::~WheeledThreadPool() {
+    Spokes *spokes;
+    {
+        //no thread is added once the pool has stopped, so the threads are
+        //joined without the lock that a growing pool thread may wait on
+        std::lock_guard<mutex> lock(tpLock);
+        spokes = threadPooledFunctions.load(std::memory_order_acquire);
+        if (spokes == nullptr) return;
+        isStarted = false;
+    }
+    //wakes each parked listener so that it sees the pool has stopped
+    for (uint32_t i=0; i<spokes->capacity(); i++){
+        spokes->getSpoke(i).spoke.wakeReader();
     }
     for (auto &t : queueMonitors){
-        t.join();
+        if (t.joinable()) t.join();
+    }
+    //leftover tasks, including any on retired spokes, are discarded
+    TaskNode *task;
+    for (uint32_t i=0; i<spokes->capacity(); i++){
+        Worker &worker = spokes->getSpoke(i);
+        worker.spoke.consumeAll([](TaskNode *task){
+            if (!task->isMarker()) task->discard();
+        });
+        while (worker.deque.pop(task)){
+            if (!task->isMarker()) task->discard();
+        }
     }
+    queueMonitors.clear();
+    threadPooledFunctions.store(nullptr, std::memory_order_release);
+    delete spokes;
 }
 
-void WheeledThreadPool::run(const std::function<void()> task) {
-    threadPooledFunctions.getSpoke().enqueue(task);
+WheeledThreadPool &WheeledThreadPool::global() {
+    //constructed on first use, so that signals connected during static
+    //initialisation find it ready
+    static WheeledThreadPool pool;
+    return pool;
+}
+
+void WheeledThreadPool::run(TaskNode *task) {
+    Spokes &spokes = runningSpokes();
+    Worker *local = currentPool == this ? currentWorker : nullptr;
+    if (local){
+        //the calling worker is busy with the task that queued this one
+        local->deque.push(task);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (nParked.load(std::memory_order_seq_cst)) wakeThief(spokes, 0);
+        else if (spokes.size() < spokes.capacity() && local->deque.size() >= growBacklog) grow(spokes, true);
+        return;
+    }
+    Worker &target = injectionTarget(spokes);
+    target.spoke.enqueue(task);
+    injected(spokes, target);
+}
+
+void WheeledThreadPool::run(TaskChain &&tasks) {
+    Spokes &spokes = runningSpokes();
+    Worker &target = injectionTarget(spokes);
+    target.spoke.enqueue(std::move(tasks));
+    injected(spokes, target);
+}
+
+void WheeledThreadPool::injected(Spokes &spokes, Worker &target) {
+    //a parked target is woken by the enqueue, work left with a busy or
+    //retired one needs another worker
+    if (target.active.load(std::memory_order_seq_cst) && !target.busy.load(std::memory_order_seq_cst)) return;
+    if (nParked.load(std::memory_order_seq_cst)){
+        wakeThief(spokes, 0);
+    }
+    else if (spokes.size() < spokes.capacity() && 
+            target.spoke.depth() + target.deque.size() >= growBacklog){
+        grow(spokes, false);
+    }
+}
+
+void WheeledThreadPool::grow(Spokes &spokes, bool wait) {
+    std::unique_lock<mutex> lock(tpLock, std::defer_lock);
+    if (wait) lock.lock();
+    else if (!lock.try_lock()) return;
+    if (!isStarted) return;
+    uint32_t size = spokes.size();
+    if (size == spokes.capacity()) return;
+    spawnWorker(spokes, size);
+    spokes.resize(size + 1);
+}
+
+bool WheeledThreadPool::retire(Spokes &spokes, uint32_t index) {
+    std::unique_lock<mutex> lock(tpLock, std::try_to_lock);
+    if (!lock.owns_lock() || !isStarted) return false;
+    uint32_t size = spokes.size();
+    if (index + 1 != size || size <= minThreads) return false;
+    spokes.resize(index);
+    spokes.getSpoke(index).active.store(false, std::memory_order_seq_cst);
+    return true;
+}
+
+void WheeledThreadPool::spawnWorker(Spokes &spokes, uint32_t index) {
+    //a retired thread has stopped taking work by the time its spoke can be
+    //handed out again, so this only waits for it to return
+    if (queueMonitors[index].joinable()) queueMonitors[index].join();
+    spokes.getSpoke(index).active.store(true, std::memory_order_seq_cst);
+    queueMonitors[index] = std::thread(&WheeledThreadPool::queueListener, this, std::ref(spokes), index);
 }
 
 void WheeledThreadPool::startup() {
     std::lock_guard<mutex> lock(tpLock);
     if (!isStarted){
+        uint32_t maxThreads = configuredMaxThreads ? configuredMaxThreads : defaultPoolSize();
+        minThreads = configuredMinThreads ? configuredMinThreads : maxThreads;
+        Spokes *spokes = new Spokes(minThreads, maxThreads);
+        queueMonitors.resize(maxThreads);
         isStarted = true;
-        for (unsigned int i=0; i<nThreads; ++i){
-            queueMonitors.emplace_back(queueListener, i);
+        for (unsigned int i=0; i<minThreads; ++i){
+            spawnWorker(*spokes, i);
         }
+        threadPooledFunctions.store(spokes, std::memory_order_release);
     }
 }
 
+bool WheeledThreadPool::configure(uint32_t threads) {
+    std::lock_guard<mutex> lock(tpLock);
+    if (isStarted) return false;
+    configuredMinThreads = configuredMaxThreads = threads;
+    idleTimeout = maxIdle;
+    return true;
+}
+
+bool WheeledThreadPool::configure(uint32_t minThreads, uint32_t maxThreads, 
+        std::chrono::steady_clock::duration idleTimeout) {
+    if (minThreads == 0 || maxThreads < minThreads) return false;
+    std::lock_guard<mutex> lock(tpLock);
+    if (isStarted) return false;
+    configuredMinThreads = minThreads;
+    configuredMaxThreads = maxThreads;
+    this->idleTimeout = idleTimeout;
+    return true;
+}
+
+uint32_t WheeledThreadPool::getPoolSize() const {
+    std::lock_guard<mutex> lock(tpLock);
+    Spokes *spokes = threadPooledFunctions.load(std::memory_order_acquire);
+    if (spokes) return spokes->size();
+    if (configuredMinThreads) return configuredMinThreads;
+    return defaultPoolSize();
+}
+
+uint32_t WheeledThreadPool::defaultPoolSize() {
+    const char *variable = std::getenv(poolSizeVariable);
+    uint32_t threads = variable ? parseCount(variable) : 0;
+    if (threads) return threads;
+    threads = availableCpus();
+    uint32_t limit = cgroupCpuLimit();
+    if (limit && (threads == 0 || limit < threads)) threads = limit;
+    return threads ? threads : fallbackPoolSize;
+}
+
+void WheeledThreadPool::setSpokeSelection(SpokeSelection selection) {
+    spokeSelection.store(selection, std::memory_order_relaxed);
+}
+
+BSignals::details::SpokeSelection WheeledThreadPool::getSpokeSelection() const {
+    return spokeSelection.load(std::memory_order_relaxed);
+}
+
 std::chrono::duration<double> WheeledThreadPool::getMaxWait() {
     return maxWait;
 }
 
-void WheeledThreadPool::queueListener(uint32_t index) {
-    auto &spoke = threadPooledFunctions.getSpoke(index);
-    std::function<void()> func;
+std::vector<BSignals::details::QueueStats> WheeledThreadPool::queueStats() const {
+    std::lock_guard<mutex> lock(tpLock);
+    std::vector<BSignals::details::QueueStats> stats;
+    Spokes *spokes = threadPooledFunctions.load(std::memory_order_acquire);
+    if (spokes == nullptr) return stats;
+    stats.reserve(spokes->capacity());
+    for (uint32_t i=0; i<spokes->capacity(); ++i){
+        stats.push_back(spokes->getSpoke(i).spoke.stats());
+    }
+    return stats;
+}
+
+std::chrono::steady_clock::duration WheeledThreadPool::getMaxIdle() {
+    return maxIdle;
+}
+
+void WheeledThreadPool::queueListener(Spokes &spokes, uint32_t index) {
+    Worker &self = spokes.getSpoke(index);
+    currentPool = this;
+    currentWorker = &self;
+    std::minstd_rand random(index + 1);
+    TaskNode *task;
     std::chrono::duration<double> waitTime = std::chrono::nanoseconds(1);
+    auto runTask = [this, &spokes, &self, index](TaskNode *task){
+        self.busy.store(true, std::memory_order_seq_cst);
+        //whatever is left behind this task is for the parked workers to
+        //take, or for a new one if there are none
+        if (nParked.load(std::memory_order_seq_cst)){
+            if (!self.deque.empty() || !self.spoke.empty()) wakeThief(spokes, index + 1);
+        }
+        else if (spokes.size() < spokes.capacity() && self.deque.size() + self.spoke.depth() >= growBacklog){
+            grow(spokes, true);
+        }
+        if (!task->isMarker()) task->run();
+        self.busy.store(false, std::memory_order_relaxed);
+    };
+    auto keepWaiting = [this, &spokes](){
+        return isStarted.load(std::memory_order_seq_cst) && !hasWork(spokes);
+    };
     while (isStarted){
-        if (spoke.dequeue(func)){
-            if (func) func();
+        if (findTask(spokes, self, random() % spokes.capacity(), task)){
+            runTask(task);
             waitTime = std::chrono::nanoseconds(1);
         }
-        else{
+        else if (waitTime <= maxWait){
             std::this_thread::sleep_for(waitTime);
             waitTime*=2;
         }
-        if (waitTime > maxWait){
-            spoke.blockingDequeue(func);
-            if (func) func();
-            waitTime = std::chrono::nanoseconds(1);
+        //parked on its own spoke with a deadline, injections there and
+        //thieves being called for both wake it
+        else if (self.tryClaim()){
+            self.parked.store(true, std::memory_order_seq_cst);
+            nParked.fetch_add(1, std::memory_order_seq_cst);
+            auto deadline = std::chrono::steady_clock::now() + idleTimeout;
+            bool found = self.spoke.blockingDequeueUntil(task, deadline, keepWaiting);
+            nParked.fetch_sub(1, std::memory_order_seq_cst);
+            self.parked.store(false, std::memory_order_relaxed);
+            self.release();
+            if (found){
+                runTask(task);
+                waitTime = std::chrono::nanoseconds(1);
+            }
+            else if (std::chrono::steady_clock::now() >= deadline && retire(spokes, index)){
+                //emitters that picked the spoke just before it was retired
+                //leave their tasks for the others
+                if (!self.spoke.empty()) wakeThief(spokes, 0);
+                break;
+            }
+        }
+    }
+    currentWorker = nullptr;
+    currentPool = nullptr;
+}
+
+bool WheeledThreadPool::findTask(Spokes &spokes, Worker &self, uint32_t victim, TaskNode *&task) {
+    if (self.deque.pop(task)) return true;
+    if (!self.spoke.empty() && self.tryClaim()){
+        bool found = drainSpoke(self, self, task);
+        self.release();
+        if (found) return true;
+    }
+    //retired spokes included
+    uint32_t n = spokes.capacity();
+    for (uint32_t i=0; i<n; ++i){
+        Worker &other = spokes.getSpoke((victim + i) % n);
+        if (&other == &self) continue;
+        if (other.deque.steal(task)){
+            //what is left behind the busy victim is for a new thread
+            if (!nParked.load(std::memory_order_seq_cst) && spokes.size() < spokes.capacity() && 
+                    other.deque.size() >= growBacklog){
+                grow(spokes, true);
+            }
+            return true;
+        }
+        //a busy worker's injected backlog is taken whole
+        if (!other.spoke.empty() && other.tryClaim()){
+            bool found = drainSpoke(self, other, task);
+            other.release();
+            if (found) return true;
+        }
+    }
+    return false;
+}
+
+bool WheeledThreadPool::drainSpoke(Worker &self, Worker &from, TaskNode *&task) {
+    //the nodes are relinked newest first, consumeAll has read each link
+    //before handing the node over
+    TaskNode *newest = nullptr;
+    std::size_t count = from.spoke.consumeAll([&newest](TaskNode *node){
+        node->next.store(newest, std::memory_order_relaxed);
+        newest = node;
+    });
+    if (count == 0) return false;
+    while (TaskNode *older = newest->next.load(std::memory_order_relaxed)){
+        self.deque.push(newest);
+        newest = older;
+    }
+    task = newest;
+    return true;
+}
+
+void WheeledThreadPool::wakeThief(Spokes &spokes, uint32_t start) {
+    uint32_t n = spokes.capacity();
+    for (uint32_t i=0; i<n; ++i){
+        Worker &worker = spokes.getSpoke((start + i) % n);
+        if (worker.parked.load(std::memory_order_seq_cst)){
+            worker.spoke.wakeReader();
+            return;
         }
     }
-}
\ No newline at end of file
+}
+
+bool WheeledThreadPool::hasWork(Spokes &spokes) {
+    for (uint32_t i=0; i<spokes.capacity(); ++i){
+        Worker &worker = spokes.getSpoke(i);
+        //a parked worker is woken for its own spoke
+        if (!worker.deque.empty()) return true;
+        if (!worker.spoke.empty() && !worker.parked.load(std::memory_order_seq_cst)) return true;
+    }
+    return false;
+}
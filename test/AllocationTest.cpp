@@ -0,0 +1,217 @@
+#include "AllocationTest.h"
+#include <iostream>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <functional>
+#include <thread>
+#include <cstdlib>
+#include <new>
+
+#include "BSignals/details/UniqueFunction.hpp"
+
+using BSignals::Signal;
+using BSignals::ExecutorScheme;
+using BSignals::details::UniqueFunction;
+using std::cout;
+using std::endl;
+
+namespace {
+thread_local uint64_t threadAllocations = 0;
+
+//A typical argument pack, larger than libstdc++'s std::function buffer
+struct Quote{
+    uint64_t instrument;
+    double bid;
+    double ask;
+    std::array<char, 16> venue;
+};
+}
+
+void *operator new(std::size_t size){
+    ++threadAllocations;
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept{
+    std::free(p);
+}
+
+void AllocationTest::SetUp() {
+    resetAllocations();
+}
+
+void AllocationTest::TearDown() {
+}
+
+uint64_t AllocationTest::allocations() {
+    return threadAllocations;
+}
+
+void AllocationTest::resetAllocations() {
+    threadAllocations = 0;
+}
+
+TEST_F(AllocationTest, UniqueFunctionStoresInline) {
+    Quote q{1, 2.0, 3.0, {}};
+    const void *slot = &q;
+    auto bound = [slot, q](){ (void)slot; (void)q; };
+    
+    resetAllocations();
+    std::function<void()> stdFunc(bound);
+    uint64_t stdAllocations = allocations();
+    
+    resetAllocations();
+    UniqueFunction<void()> uniqueFunc(bound);
+    UniqueFunction<void()> moved(std::move(uniqueFunc));
+    moved();
+    
+    cout << "std::function allocations: " << stdAllocations << endl;
+    ASSERT_EQ(0u, allocations());
+    ASSERT_TRUE(moved.isInline());
+    ASSERT_FALSE(uniqueFunc);
+}
+
+TEST_F(AllocationTest, UniqueFunctionHeapFallback) {
+    std::array<char, 256> big{};
+    uint32_t calls = 0;
+    UniqueFunction<void(uint32_t)> f([big, &calls](uint32_t x){ calls += x + big[0]; });
+    ASSERT_FALSE(f.isInline());
+    UniqueFunction<void(uint32_t)> g(std::move(f));
+    g(2);
+    ASSERT_EQ(2u, calls);
+}
+
+TEST_F(AllocationTest, EmissionAllocations) {
+    const uint32_t nEmissions = 1000;
+    const uint32_t nWarmup = 100000;
+    std::atomic<uint32_t> completed{0};
+    auto func = [&completed](const Quote &q){ if (q.instrument) completed++; };
+    Quote q{1, 2.0, 3.0, {}};
+    
+    Signal<Quote> syncSignal;
+    Signal<Quote> strandSignal;
+    Signal<Quote> pooledSignal;
+    syncSignal.connectSlot(ExecutorScheme::SYNCHRONOUS, func);
+    strandSignal.connectSlot(ExecutorScheme::STRAND, func);
+    pooledSignal.connectSlot(ExecutorScheme::THREAD_POOLED, func);
+    
+    //fill the node pool first, every consumer thread may hold back up to
+    //two batches of nodes in its own cache
+    for (uint32_t i=0; i<nWarmup; ++i){
+        strandSignal.emitSignal(q);
+        pooledSignal.emitSignal(q);
+    }
+    while (completed != 2*nWarmup) std::this_thread::yield();
+    completed = 0;
+    
+    resetAllocations();
+    for (uint32_t i=0; i<nEmissions; ++i) syncSignal.emitSignal(q);
+    uint64_t syncAllocations = allocations();
+    
+    resetAllocations();
+    for (uint32_t i=0; i<nEmissions; ++i) strandSignal.emitSignal(q);
+    uint64_t strandAllocations = allocations();
+    
+    resetAllocations();
+    for (uint32_t i=0; i<nEmissions; ++i) pooledSignal.emitSignal(q);
+    uint64_t pooledAllocations = allocations();
+    
+    while (completed != 3*nEmissions) std::this_thread::yield();
+    
+    cout << "Allocations per emission (synchronous): " << (double)syncAllocations/nEmissions << endl;
+    cout << "Allocations per emission (strand): " << (double)strandAllocations/nEmissions << endl;
+    cout << "Allocations per emission (thread pooled): " << (double)pooledAllocations/nEmissions << endl;
+    
+    //the bound task is stored inline and queue nodes are recycled
+    ASSERT_EQ(0u, syncAllocations);
+    ASSERT_EQ(0u, strandAllocations);
+    ASSERT_EQ(0u, pooledAllocations);
+}
+
+TEST_F(AllocationTest, LargeArgumentAllocations) {
+    const uint32_t nEmissions = 1000;
+    const uint32_t nWarmup = 100000;
+    std::atomic<uint32_t> completed{0};
+    //too large for the inline storage of a type erased task
+    typedef std::array<char, 256> Frame;
+    auto func = [&completed](const Frame &f){ if (!f[0]) completed++; };
+    Frame frame{};
+    
+    Signal<Frame> strandSignal;
+    Signal<Frame> pooledSignal;
+    strandSignal.connectSlot(ExecutorScheme::STRAND, func);
+    pooledSignal.connectSlot(ExecutorScheme::THREAD_POOLED, func);
+    for (uint32_t i=0; i<nWarmup; ++i){
+        strandSignal.emitSignal(frame);
+        pooledSignal.emitSignal(frame);
+    }
+    while (completed != 2*nWarmup) std::this_thread::yield();
+    
+    resetAllocations();
+    for (uint32_t i=0; i<nEmissions; ++i){
+        strandSignal.emitSignal(frame);
+        pooledSignal.emitSignal(frame);
+    }
+    uint64_t largeAllocations = allocations();
+    while (completed != 2*(nWarmup + nEmissions)) std::this_thread::yield();
+    
+    cout << "Allocations per emission (256 byte argument): " << (double)largeAllocations/(2*nEmissions) << endl;
+    
+    //the task node is sized for the bound arguments and drawn from a pool
+    ASSERT_EQ(0u, largeAllocations);
+}
+
+TEST_F(AllocationTest, FanOutAllocations) {
+    const uint32_t nEmissions = 1000;
+    const uint32_t nSlots = 10;
+    std::atomic<uint32_t> completed{0};
+    Signal<std::vector<int>> fanOutSignal;
+    for (uint32_t i=0; i<nSlots; ++i){
+        fanOutSignal.connectSlot(ExecutorScheme::STRAND, [&completed](const std::vector<int> &v){ if (!v.empty()) completed++; });
+    }
+    std::vector<int> values(64, 1);
+    
+    resetAllocations();
+    for (uint32_t i=0; i<nEmissions; ++i) fanOutSignal.emitSignal(values);
+    uint64_t fanOutAllocations = allocations();
+    while (completed != nSlots*nEmissions) std::this_thread::yield();
+    
+    cout << "Allocations per emission (" << nSlots << " strands): " << (double)fanOutAllocations/nEmissions << endl;
+    
+    //one queue node per slot plus at most the pooled payload block and its
+    //single copy of the vector, rather than a copy of the vector per slot
+    ASSERT_LE(fanOutAllocations, (uint64_t)nEmissions*(nSlots + 2));
+}
+
+TEST_F(AllocationTest, BatchAllocations) {
+    const uint32_t nBatches = 100;
+    const uint32_t nWarmup = 10000;
+    std::atomic<uint32_t> completed{0};
+    auto func = [&completed](uint32_t){ completed++; };
+    std::vector<uint32_t> batch(10, 1);
+    
+    Signal<uint32_t> batchSignal;
+    batchSignal.connectSlot(ExecutorScheme::SYNCHRONOUS, func);
+    batchSignal.connectSlot(ExecutorScheme::STRAND, func);
+    batchSignal.connectSlot(ExecutorScheme::THREAD_POOLED, func);
+    //batched tasks have node pools of their own, fill those first
+    for (uint32_t i=0; i<nWarmup; ++i) batchSignal.emitSignalBatch(batch.begin(), batch.end());
+    while (completed != 3*nWarmup*batch.size()) std::this_thread::yield();
+    completed = 0;
+    
+    resetAllocations();
+    for (uint32_t i=0; i<nBatches; ++i) batchSignal.emitSignalBatch(batch.begin(), batch.end());
+    uint64_t batchAllocations = allocations();
+    while (completed != 3*nBatches*batch.size()) std::this_thread::yield();
+    
+    cout << "Allocations per batch (" << batch.size() << " emissions): " << (double)batchAllocations/nBatches << endl;
+    
+    //the per slot chains live on the stack for small slot lists
+    ASSERT_EQ(0u, batchAllocations);
+}
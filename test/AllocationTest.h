@@ -0,0 +1,24 @@
+/* 
+ * File:   AllocationTest.h
+ *
+ * Counts heap allocations made on the emitting thread
+ */
+
+#ifndef ALLOCATIONTEST_H
+#define ALLOCATIONTEST_H
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include "BSignals/Signal.hpp"
+
+class AllocationTest : public testing::Test{
+public:
+    virtual void SetUp();
+    virtual void TearDown();
+    
+    //Allocations made by the calling thread since the last reset
+    static uint64_t allocations();
+    static void resetAllocations();
+};
+
+#endif /* ALLOCATIONTEST_H */
@@ -0,0 +1,558 @@
+#include "SignalBenchmark.h"
+#include <iostream>
+#include <map>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <shared_mutex>
+#include <condition_variable>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <array>
+#include <memory>
+
+#include "BSignals/StaticSignal.hpp"
+#include "BSignals/details/BasicTimer.h"
+#include "BSignals/details/TaskQueue.h"
+#include "BSignals/details/Wheel.hpp"
+#include "BSignals/details/CacheLine.h"
+
+using BSignals::details::BasicTimer;
+using BSignals::details::TaskQueue;
+using BSignals::details::Wheel;
+using BSignals::details::TaskNode;
+using BSignals::details::makeTask;
+using BSignals::Signal;
+using BSignals::StaticSignal;
+using BSignals::ExecutorScheme;
+using BSignals::Connection;
+using BSignals::ScopedConnection;
+using std::cout;
+using std::endl;
+using ::testing::Values;
+
+namespace {
+
+const uint32_t nEmissions = 100000;
+
+//Reference copy of the original map based dispatch, emitting only to
+//synchronous slots but still walking every executor map
+template <typename... Args>
+class MapDispatchSignal{
+public:
+    void connectSlot(std::function<void(Args...)> slot){
+        synchronousSlots.emplace(currentId++, slot);
+    }
+    
+    void emitSignal(const Args &... p) const{
+        for (auto const &slot : synchronousSlots) slot.second(p...);
+        for (auto const &slot : asynchronousSlots) slot.second(p...);
+        for (auto const &slot : strandSlots) slot.second(p...);
+        for (auto const &slot : threadPooledSlots) slot.second(p...);
+    }
+    
+private:
+    uint32_t currentId{0};
+    std::map<uint32_t, std::function<void(Args...)>> synchronousSlots;
+    std::map<uint32_t, std::function<void(Args...)>> asynchronousSlots;
+    std::map<uint32_t, std::function<void(Args...)>> strandSlots;
+    std::map<uint32_t, std::function<void(Args...)>> threadPooledSlots;
+};
+
+//Reference copy of the original thread safe emission, guarded by a shared lock
+template <typename... Args>
+class SharedLockSignal{
+public:
+    void connectSlot(std::function<void(Args...)> slot){
+        std::unique_lock<std::shared_timed_mutex> lock(signalLock);
+        slots.push_back(slot);
+    }
+    
+    void emitSignal(const Args &... p) const{
+        std::shared_lock<std::shared_timed_mutex> lock(signalLock);
+        for (auto const &slot : slots) slot(p...);
+    }
+    
+private:
+    mutable std::shared_timed_mutex signalLock;
+    std::vector<std::function<void(Args...)>> slots;
+};
+
+//Reference for the original queue wakeup, every enqueue took a shared lock
+//to check for a parked reader. The reader registers under the exclusive
+//lock here, the original could miss a wakeup. It wraps the task queue that
+//strands and the pool block on, whose own event count is then only loaded
+class SharedLockWakeQueue{
+public:
+    void enqueue(TaskNode *node){
+        queue.enqueue(node);
+        std::shared_lock<std::shared_timed_mutex> lock(mutex);
+        if (waitingReader) cv.notify_one();
+    }
+    
+    void blockingDequeue(TaskNode *&output){
+        std::unique_lock<std::shared_timed_mutex> lock(mutex);
+        waitingReader = true;
+        while (!queue.dequeue(output)) cv.wait(lock);
+        waitingReader = false;
+    }
+    
+private:
+    TaskQueue queue;
+    std::shared_timed_mutex mutex;
+    std::condition_variable_any cv;
+    bool waitingReader{false};
+};
+
+//Enqueues tasks from nProducers threads into one blocking reader that runs
+//them, as a strand does, returns the average time per task
+template <typename Q>
+double timeProducers(uint32_t nProducers, uint32_t nPerProducer){
+    Q queue;
+    std::atomic<bool> go{false};
+    std::atomic<uint32_t> sum{0};
+    std::vector<std::thread> producers;
+    for (uint32_t t=0; t<nProducers; ++t){
+        producers.emplace_back([&queue, &go, &sum, nPerProducer](){
+            while (!go) std::this_thread::yield();
+            for (uint32_t i=0; i<nPerProducer; ++i){
+                queue.enqueue(makeTask([&sum, i](){ sum.fetch_add(i, std::memory_order_relaxed); }));
+            }
+        });
+    }
+    BasicTimer bt;
+    bt.start();
+    go = true;
+    TaskNode *task;
+    for (uint32_t i=0; i<nProducers*nPerProducer; ++i){
+        queue.blockingDequeue(task);
+        task->run();
+    }
+    bt.stop();
+    for (auto &t : producers) t.join();
+    return bt.getElapsedNanoseconds()/(nProducers*nPerProducer);
+}
+
+//Runs work(worker index, iterations) on nWorkers threads concurrently,
+//returns the average time per iteration
+template <typename F>
+double timeWorkers(uint32_t nWorkers, uint32_t nIterations, F work){
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    BasicTimer bt;
+    for (uint32_t t=0; t<nWorkers; ++t){
+        workers.emplace_back([&go, &work, t, nIterations](){
+            while (!go) std::this_thread::yield();
+            work(t, nIterations);
+        });
+    }
+    bt.start();
+    go = true;
+    for (auto &t : workers) t.join();
+    bt.stop();
+    return bt.getElapsedNanoseconds()/(nWorkers*nIterations);
+}
+
+//A counter padded out to a cache line of its own
+struct PaddedCounter{
+    std::atomic<uint64_t> value{0};
+    char pad[BSignals::details::cacheLineSize - sizeof(std::atomic<uint64_t>)];
+};
+
+//Emits from nThreads threads concurrently, returns the average time per emit
+template <typename S>
+double timeConcurrentEmission(const S &signal, uint32_t nThreads, uint32_t nEmissionsPerThread){
+    std::atomic<bool> go{false};
+    std::vector<std::thread> emitters;
+    BasicTimer bt;
+    for (uint32_t t=0; t<nThreads; ++t){
+        emitters.emplace_back([&signal, &go, nEmissionsPerThread](){
+            while (!go) std::this_thread::yield();
+            for (uint32_t i=0; i<nEmissionsPerThread; ++i){
+                signal.emitSignal(i);
+            }
+        });
+    }
+    bt.start();
+    go = true;
+    for (auto &t : emitters) t.join();
+    bt.stop();
+    return bt.getElapsedNanoseconds()/(nThreads*nEmissionsPerThread);
+}
+
+}
+
+TEST_P(SignalBenchmarkParametrized, SynchronousEmitLatency) {
+    uint32_t nConnections = GetParam();
+    volatile uint32_t sink = 0;
+    auto func = [&sink](uint32_t x){ sink = sink + x; };
+    
+    MapDispatchSignal<uint32_t> before;
+    Signal<uint32_t> after;
+    for (uint32_t i=0; i<nConnections; ++i){
+        before.connectSlot(func);
+        after.connectSlot(ExecutorScheme::SYNCHRONOUS, func);
+    }
+    
+    BasicTimer bt;
+    bt.start();
+    for (uint32_t i=0; i<nEmissions; ++i){
+        before.emitSignal(i);
+    }
+    bt.stop();
+    double beforeNs = bt.getElapsedNanoseconds()/nEmissions;
+    
+    bt.start();
+    for (uint32_t i=0; i<nEmissions; ++i){
+        after.emitSignal(i);
+    }
+    bt.stop();
+    double afterNs = bt.getElapsedNanoseconds()/nEmissions;
+    
+    cout << "Connections: " << nConnections << endl;
+    cout << "Average emit time (map dispatch): " << beforeNs << "ns" << endl;
+    cout << "Average emit time (flat dispatch): " << afterNs << "ns" << endl;
+}
+
+TEST_P(SignalBenchmarkParametrized, StaticSynchronousEmitLatency) {
+    uint32_t nConnections = GetParam();
+    volatile uint32_t sink = 0;
+    auto func = [&sink](uint32_t x){ sink = sink + x; };
+    
+    Signal<uint32_t> dynamicSignal;
+    StaticSignal<ExecutorScheme::SYNCHRONOUS, uint32_t> staticSignal;
+    for (uint32_t i=0; i<nConnections; ++i){
+        dynamicSignal.connectSlot(ExecutorScheme::SYNCHRONOUS, func);
+        staticSignal.connectSlot(func);
+    }
+    
+    BasicTimer bt;
+    bt.start();
+    for (uint32_t i=0; i<nEmissions; ++i){
+        dynamicSignal.emitSignal(i);
+    }
+    bt.stop();
+    double dynamicNs = bt.getElapsedNanoseconds()/nEmissions;
+    
+    bt.start();
+    for (uint32_t i=0; i<nEmissions; ++i){
+        staticSignal.emitSignal(i);
+    }
+    bt.stop();
+    double staticNs = bt.getElapsedNanoseconds()/nEmissions;
+    
+    cout << "Connections: " << nConnections << endl;
+    cout << "Average emit time (Signal): " << dynamicNs << "ns" << endl;
+    cout << "Average emit time (StaticSignal): " << staticNs << "ns" << endl;
+}
+
+TEST_P(SignalScalingBenchmark, ThreadSafeEmitScaling) {
+    uint32_t nThreads = GetParam();
+    const uint32_t nEmissionsPerThread = 20000;
+    auto func = [](uint32_t x){ volatile uint32_t v = x; (void)v; };
+    
+    SharedLockSignal<uint32_t> before;
+    Signal<uint32_t> safe(true);
+    Signal<uint32_t> unsafe(false);
+    before.connectSlot(func);
+    safe.connectSlot(ExecutorScheme::SYNCHRONOUS, func);
+    unsafe.connectSlot(ExecutorScheme::SYNCHRONOUS, func);
+    
+    cout << "Emitting threads: " << nThreads << endl;
+    cout << "Average emit time (shared lock): " << timeConcurrentEmission(before, nThreads, nEmissionsPerThread) << "ns" << endl;
+    cout << "Average emit time (thread safe): " << timeConcurrentEmission(safe, nThreads, nEmissionsPerThread) << "ns" << endl;
+    cout << "Average emit time (unsafe): " << timeConcurrentEmission(unsafe, nThreads, nEmissionsPerThread) << "ns" << endl;
+}
+
+TEST_F(SignalBenchmark, ConnectDuringEmission) {
+    Signal<uint32_t> signal(true);
+    std::atomic<uint32_t> calls{0};
+    std::atomic<bool> stop{false};
+    signal.connectSlot(ExecutorScheme::SYNCHRONOUS, [&calls](uint32_t){ calls++; });
+    
+    std::vector<std::thread> emitters;
+    for (uint32_t t=0; t<4; ++t){
+        emitters.emplace_back([&signal, &stop](){
+            while (!stop) signal.emitSignal(1);
+        });
+    }
+    for (uint32_t i=0; i<1000; ++i){
+        int id = signal.connectSlot(ExecutorScheme::SYNCHRONOUS, [&calls](uint32_t){ calls++; });
+        signal.disconnectSlot(id);
+    }
+    stop = true;
+    for (auto &t : emitters) t.join();
+    
+    uint32_t before = calls;
+    signal.emitSignal(1);
+    ASSERT_EQ(before + 1, calls);
+}
+
+TEST_F(SignalBenchmark, DisconnectStorm) {
+    const uint32_t nSlots = 20;
+    const uint32_t backlog = 100;
+    Signal<uint32_t> signal(true);
+    std::atomic<uint32_t> strandCalls{0};
+    std::atomic<bool> stop{false};
+    signal.connectSlot(ExecutorScheme::SYNCHRONOUS, [](uint32_t){});
+    
+    //emit latency is sampled continuously while strand slots come and go
+    std::vector<double> latencies;
+    std::thread emitter([&signal, &stop, &latencies](){
+        while (!stop){
+            auto start = std::chrono::steady_clock::now();
+            signal.emitSignal(1);
+            latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+        }
+    });
+    
+    auto slowSlot = [&strandCalls](uint32_t){
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+        strandCalls++;
+    };
+    auto storm = [&](bool async){
+        std::vector<std::shared_future<void>> pending;
+        BasicTimer bt;
+        double disconnectTime = 0;
+        for (uint32_t i=0; i<nSlots; ++i){
+            int id = signal.connectSlot(ExecutorScheme::STRAND, slowSlot);
+            for (uint32_t j=0; j<backlog; ++j) signal.emitSignal(2);
+            bt.start();
+            if (async) pending.push_back(signal.disconnectSlotAsync(id));
+            else signal.disconnectSlot(id);
+            bt.stop();
+            disconnectTime += bt.getElapsedNanoseconds();
+        }
+        for (auto &f : pending) f.wait();
+        return disconnectTime/nSlots;
+    };
+    double blocking = storm(false);
+    double async = storm(true);
+    stop = true;
+    emitter.join();
+    
+    uint32_t calls = strandCalls;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(calls, strandCalls);
+    
+    std::sort(latencies.begin(), latencies.end());
+    cout << "Average disconnect time (blocking): " << blocking << "ns" << endl;
+    cout << "Average disconnect time (async): " << async << "ns" << endl;
+    cout << "Emit latency during storm p50: " << latencies[latencies.size()/2] << "ns, p99: " <<
+        latencies[latencies.size()*99/100] << "ns, max: " << latencies.back() << "ns" << endl;
+}
+
+TEST_P(SignalChurnBenchmark, ConnectionChurn) {
+    const uint32_t resident = GetParam();
+    const uint32_t nChurn = 10000;
+    Signal<uint32_t> signal(true);
+    std::vector<Connection> residents;
+    for (uint32_t i=0; i<resident; ++i){
+        residents.push_back(signal.connect(ExecutorScheme::SYNCHRONOUS, [](uint32_t){}));
+    }
+    
+    //short lived subscribers connecting and disconnecting in turn
+    BasicTimer bt;
+    bt.start();
+    for (uint32_t i=0; i<nChurn; ++i){
+        ScopedConnection subscriber = signal.connect(ExecutorScheme::SYNCHRONOUS, [](uint32_t){});
+    }
+    bt.stop();
+    double scoped = bt.getElapsedNanoseconds()/nChurn;
+    
+    //bursts of subscribers that leave together, in arrival order
+    std::vector<Connection> burst;
+    bt.start();
+    for (uint32_t i=0; i<nChurn; ++i){
+        burst.push_back(signal.connect(ExecutorScheme::SYNCHRONOUS, [](uint32_t){}));
+        if (burst.size() == 100){
+            for (auto &c : burst) c.disconnect();
+            burst.clear();
+        }
+    }
+    bt.stop();
+    double bursts = bt.getElapsedNanoseconds()/nChurn;
+    
+    cout << "Resident connections: " << resident << endl;
+    cout << "Average connect+disconnect time (single): " << scoped << "ns" << endl;
+    cout << "Average connect+disconnect time (bursts of 100): " << bursts << "ns" << endl;
+    uint32_t calls = 0;
+    for (auto &c : residents) calls += c.connected();
+    ASSERT_EQ(resident, calls);
+}
+
+TEST_P(QueueProducerBenchmark, BlockingReaderThroughput) {
+    uint32_t nProducers = GetParam();
+    const uint32_t nPerProducer = 200000/nProducers;
+    
+    cout << "Producing threads: " << nProducers << endl;
+    cout << "Average enqueue+dequeue time (shared lock wakeup): " << 
+        timeProducers<SharedLockWakeQueue>(nProducers, nPerProducer) << "ns" << endl;
+    cout << "Average enqueue+dequeue time (event count wakeup): " << 
+        timeProducers<TaskQueue>(nProducers, nPerProducer) << "ns" << endl;
+}
+
+TEST_F(SignalBenchmark, SingleProducerStrand) {
+    //room for every emission, so that only the enqueue itself is timed
+    const uint32_t capacity = 1 << 17;
+    std::atomic<uint32_t> counter{0};
+    auto func = [&counter](uint32_t){ counter.fetch_add(1, std::memory_order_relaxed); };
+    auto timeEmissions = [&counter](const Signal<uint32_t> &signal){
+        counter = 0;
+        BasicTimer bt;
+        bt.start();
+        for (uint32_t i=0; i<nEmissions; ++i){
+            signal.emitSignal(i);
+        }
+        bt.stop();
+        while (counter != nEmissions) std::this_thread::yield();
+        return bt.getElapsedNanoseconds()/nEmissions;
+    };
+    
+    Signal<uint32_t> unbounded, multiple, single;
+    unbounded.connect(ExecutorScheme::STRAND, func);
+    multiple.connect(ExecutorScheme::STRAND, func, BSignals::QueueLimit{capacity, BSignals::OverflowPolicy::BLOCK});
+    single.connect(ExecutorScheme::STRAND, func, BSignals::QueueLimit{capacity, BSignals::OverflowPolicy::BLOCK, true});
+    
+    cout << "Average emit time (unbounded MPSC strand): " << timeEmissions(unbounded) << "ns" << endl;
+    cout << "Average emit time (bounded MPMC strand): " << timeEmissions(multiple) << "ns" << endl;
+    cout << "Average emit time (bounded SPSC strand): " << timeEmissions(single) << "ns" << endl;
+}
+
+TEST_F(SignalBenchmark, SpokeFalseSharing) {
+    //every worker only ever touches its own slot, any slowdown of the packed
+    //layout comes from cache lines bouncing between the workers' cores
+    const uint32_t nWorkers = 32;
+    const uint32_t nIterations = 200000;
+    
+    std::array<std::atomic<uint64_t>, nWorkers> packed{};
+    double packedTime = timeWorkers(nWorkers, nIterations, [&packed](uint32_t t, uint32_t n){
+        for (uint32_t i=0; i<n; ++i) packed[t].fetch_add(1, std::memory_order_relaxed);
+    });
+    std::unique_ptr<std::array<PaddedCounter, nWorkers>> padded(new std::array<PaddedCounter, nWorkers>());
+    double paddedTime = timeWorkers(nWorkers, nIterations, [&padded](uint32_t t, uint32_t n){
+        for (uint32_t i=0; i<n; ++i) (*padded)[t].value.fetch_add(1, std::memory_order_relaxed);
+    });
+    
+    //each worker feeds and drains its own spoke, as a busy pool listener
+    //with a local producer would
+    std::unique_ptr<Wheel<TaskQueue>> wheel(new Wheel<TaskQueue>(nWorkers));
+    double spokeTime = timeWorkers(nWorkers, nIterations, [&wheel](uint32_t t, uint32_t n){
+        TaskQueue &spoke = wheel->getSpoke(t);
+        TaskNode marker;
+        for (uint32_t i=0; i<n; ++i){
+            spoke.enqueue(&marker);
+            spoke.consumeAll([](TaskNode*){});
+        }
+    });
+    
+    cout << "Busy workers: " << nWorkers << endl;
+    cout << "Average increment time (packed counters): " << packedTime << "ns" << endl;
+    cout << "Average increment time (padded counters): " << paddedTime << "ns" << endl;
+    cout << "Average enqueue+consumeAll time (own spoke): " << spokeTime << "ns" << endl;
+    uint64_t total = 0;
+    for (uint32_t t=0; t<nWorkers; ++t) total += wheel->getSpoke(t).stats().dequeued;
+    ASSERT_EQ(uint64_t(nWorkers)*nIterations, total);
+}
+
+TEST_F(SignalBenchmark, PooledMixedSlotLatency) {
+    //mostly short invocations with the odd long one, as in the intense usage
+    //tests, timing how long each emission waits before its slot starts and
+    //until it completes
+    const uint32_t nPooledEmissions = 2000;
+    const uint32_t longEvery = 100;
+    typedef std::chrono::steady_clock Clock;
+    std::vector<double> waits(nPooledEmissions), completions(nPooledEmissions);
+    std::atomic<uint32_t> completed{0};
+    Signal<Clock::time_point, uint32_t, uint32_t> signal;
+    signal.connect(ExecutorScheme::THREAD_POOLED, [&](Clock::time_point emitted, uint32_t index, uint32_t nOperations){
+        waits[index] = std::chrono::duration<double, std::micro>(Clock::now() - emitted).count();
+        volatile uint32_t v = 0;
+        for (uint32_t i=0; i<nOperations; ++i) v += i;
+        completions[index] = std::chrono::duration<double, std::micro>(Clock::now() - emitted).count();
+        completed++;
+    });
+    auto percentile = [](std::vector<double> &samples, uint32_t p){
+        std::sort(samples.begin(), samples.end());
+        return samples[(samples.size() - 1)*p/100];
+    };
+    
+    cout << "Pool threads: " << BSignals::threadPoolSize() << endl;
+    for (auto selection : {BSignals::SpokeSelection::ROUND_ROBIN, BSignals::SpokeSelection::LEAST_LOADED_OF_TWO}){
+        BSignals::setThreadPoolSelection(selection);
+        completed = 0;
+        for (uint32_t i=0; i<nPooledEmissions; ++i){
+            signal.emitSignal(Clock::now(), i, i % longEvery ? 1000 : 1000000);
+            //paced so that the pool isn't simply saturated
+            if (i % 10 == 0) std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        while (completed != nPooledEmissions) std::this_thread::yield();
+        
+        cout << (selection == BSignals::SpokeSelection::ROUND_ROBIN ? "Round robin:" : "Least loaded of two:") << endl;
+        cout << "Wait before slot start (p50, p99): " << percentile(waits, 50) << "us, " << 
+            percentile(waits, 99) << "us" << endl;
+        cout << "Completion time (p50, p99, max): " << percentile(completions, 50) << "us, " << 
+            percentile(completions, 99) << "us, " << percentile(completions, 100) << "us" << endl;
+    }
+    BSignals::setThreadPoolSelection(BSignals::SpokeSelection::LEAST_LOADED_OF_TWO);
+}
+
+TEST_P(QueueBurstBenchmark, BurstDrain) {
+    uint32_t burst = GetParam();
+    const uint32_t nBursts = 1000000/burst;
+    double singleTime = 0.0, bulkTime = 0.0;
+    uint32_t counter = 0;
+    TaskQueue queue;
+    TaskNode *task;
+    BasicTimer bt;
+    for (uint32_t i=0; i<nBursts; ++i){
+        for (uint32_t j=0; j<burst; ++j) queue.enqueue(makeTask([&counter](){ ++counter; }));
+        bt.start();
+        while (queue.dequeue(task)) task->run();
+        bt.stop();
+        singleTime += bt.getElapsedNanoseconds();
+        
+        for (uint32_t j=0; j<burst; ++j) queue.enqueue(makeTask([&counter](){ ++counter; }));
+        bt.start();
+        queue.consumeAll([](TaskNode *task){ task->run(); });
+        bt.stop();
+        bulkTime += bt.getElapsedNanoseconds();
+    }
+    
+    cout << "Burst size: " << burst << endl;
+    cout << "Average drain time per task (dequeue): " << singleTime/(nBursts*burst) << "ns" << endl;
+    cout << "Average drain time per task (consumeAll): " << bulkTime/(nBursts*burst) << "ns" << endl;
+    ASSERT_EQ(2*nBursts*burst, counter);
+}
+
+INSTANTIATE_TEST_CASE_P(
+        SignalBenchmark_QueueBursts,
+        QueueBurstBenchmark,
+        Values(10, 100, 1000, 10000) //tasks per burst
+        );
+
+INSTANTIATE_TEST_CASE_P(
+        SignalBenchmark_QueueProducers,
+        QueueProducerBenchmark,
+        Values(1, 2, 4, 8, 16) //number of producing threads
+        );
+
+INSTANTIATE_TEST_CASE_P(
+        SignalBenchmark_EmitScaling,
+        SignalScalingBenchmark,
+        Values(1, 2, 4, 8, 16, 32, 64) //number of emitting threads
+        );
+
+INSTANTIATE_TEST_CASE_P(
+        SignalBenchmark_ConnectionChurn,
+        SignalChurnBenchmark,
+        Values(10, 1000, 100000) //number of resident connections
+        );
+
+INSTANTIATE_TEST_CASE_P(
+        SignalBenchmark_EmitLatency,
+        SignalBenchmarkParametrized,
+        Values(1, 10, 50) //number of connections
+        );
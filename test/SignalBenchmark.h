@@ -0,0 +1,36 @@
+/* 
+ * File:   SignalBenchmark.h
+ *
+ * Micro benchmarks for the emission path
+ */
+
+#ifndef SIGNALBENCHMARK_H
+#define SIGNALBENCHMARK_H
+
+#include <gtest/gtest.h>
+#include "BSignals/Signal.hpp"
+
+class SignalBenchmark : public testing::Test{
+};
+
+class SignalBenchmarkParametrized : public SignalBenchmark,
+        public testing::WithParamInterface<uint32_t>{
+};
+
+class SignalScalingBenchmark : public SignalBenchmark,
+        public testing::WithParamInterface<uint32_t>{
+};
+
+class SignalChurnBenchmark : public SignalBenchmark,
+        public testing::WithParamInterface<uint32_t>{
+};
+
+class QueueProducerBenchmark : public SignalBenchmark,
+        public testing::WithParamInterface<uint32_t>{
+};
+
+class QueueBurstBenchmark : public SignalBenchmark,
+        public testing::WithParamInterface<uint32_t>{
+};
+
+#endif /* SIGNALBENCHMARK_H */
@@ -4,12 +4,28 @@
 #include <vector>
 #include <thread>
 #include <atomic>
-
+#include <memory>
+#include <algorithm>
+#include <tuple>
+#include <chrono>
+#include <set>
+#include <mutex>
+#include <functional>
+#include <stdexcept>
+
+#include "BSignals/StaticSignal.hpp"
 #include "BSignals/details/BasicTimer.h"
 #include "BSignals/details/SafeQueue.hpp"
+#include "BSignals/details/MPSCQueue.hpp"
+#include "BSignals/details/TaskQueue.h"
+#include "BSignals/details/WorkStealingDeque.hpp"
 #include "FunctionTimeRegular.hpp"
 
 using BSignals::details::SafeQueue;
+using BSignals::details::MPSCQueue;
+using BSignals::details::TaskQueue;
+using BSignals::details::TaskNode;
+using BSignals::details::WorkStealingDeque;
 using BSignals::details::BasicTimer;
 using std::cout;
 using std::endl;
@@ -20,7 +36,12 @@ using std::thread;
 using std::atomic;
 using std::fixed;
 using BSignals::Signal;
+using BSignals::StaticSignal;
 using BSignals::ExecutorScheme;
+using BSignals::Connection;
+using BSignals::ScopedConnection;
+using BSignals::ConnectionBlocker;
+using BSignals::ThreadPool;
 
 int globalStaticIntX = 0;
 
@@ -184,6 +205,142 @@ TEST_F(SignalTest, MultipleConnectionTypes) {
     ASSERT_LT(bt.getElapsedSeconds(), 0.2);
 }
 
+TEST_F(SignalTest, StaticSignalExecutors) {
+    atomic<uint32_t> sum{0};
+    auto func = [&sum](uint32_t x){ sum += x; };
+    
+    StaticSignal<ExecutorScheme::SYNCHRONOUS, uint32_t> syncSignal;
+    StaticSignal<ExecutorScheme::ASYNCHRONOUS, uint32_t> asyncSignal(true, 16u);
+    StaticSignal<ExecutorScheme::STRAND, uint32_t> strandSignal(true);
+    StaticSignal<ExecutorScheme::THREAD_POOLED, uint32_t> pooledSignal;
+    
+    int id = syncSignal.connectSlot(func);
+    syncSignal.connectSlot(func);
+    asyncSignal.connectSlot(func);
+    strandSignal.connectSlot(func);
+    pooledSignal.connectSlot(func);
+    
+    syncSignal.emitSignal(1);
+    ASSERT_EQ(2u, sum);
+    syncSignal.disconnectSlot(id);
+    syncSignal.emitSignal(1);
+    ASSERT_EQ(3u, sum);
+    
+    ASSERT_TRUE(asyncSignal.emitSignal(10));
+    ASSERT_TRUE(strandSignal.emitSignal(100));
+    ASSERT_TRUE(pooledSignal.emitSignal(1000));
+    
+    BasicTimer bt;
+    bt.start();
+    while (sum != 1113 && bt.getElapsedSeconds() < 1.0) {
+        std::this_thread::yield();
+    }
+    ASSERT_EQ(1113u, sum);
+    strandSignal.disconnectAllSlots();
+}
+
+struct CopyCounter {
+    CopyCounter() = default;
+    CopyCounter(const CopyCounter &) { copies++; }
+    CopyCounter(CopyCounter &&) noexcept { moves++; }
+    CopyCounter &operator=(const CopyCounter &) { copies++; return *this; }
+    CopyCounter &operator=(CopyCounter &&) noexcept { moves++; return *this; }
+    static atomic<uint32_t> copies;
+    static atomic<uint32_t> moves;
+};
+atomic<uint32_t> CopyCounter::copies{0};
+atomic<uint32_t> CopyCounter::moves{0};
+
+TEST_F(SignalTest, RvalueEmissionMovesIntoLastSlot) {
+    const uint32_t nSlots = 4;
+    atomic<uint32_t> completed{0};
+    Signal<CopyCounter> testSignal;
+    for (uint32_t i = 0; i < nSlots; i++) {
+        testSignal.connectSlot(ExecutorScheme::STRAND, [&completed](const CopyCounter &) { completed++; });
+    }
+    
+    CopyCounter payload;
+    CopyCounter::copies = 0;
+    testSignal.emitSignal(payload);
+    while (completed != nSlots) std::this_thread::yield();
+    cout << "Copies for lvalue emission: " << CopyCounter::copies << endl;
+    //the queued slots share a single payload
+    ASSERT_EQ(1u, CopyCounter::copies);
+    
+    CopyCounter::copies = 0;
+    testSignal.emitSignal(std::move(payload));
+    while (completed != 2*nSlots) std::this_thread::yield();
+    cout << "Copies for rvalue emission: " << CopyCounter::copies << endl;
+    ASSERT_EQ(0u, CopyCounter::copies);
+    
+    testSignal.disconnectAllSlots();
+}
+
+TEST_F(SignalTest, MoveOnlyArguments) {
+    const uint32_t nEmissions = 100;
+    typedef std::unique_ptr<uint32_t> Buffer;
+    atomic<uint32_t> stranded{0};
+    atomic<uint32_t> pooled{0};
+    
+    //a buffer can only go to one slot, a second slot is rejected
+    Signal<Buffer> testSignal;
+    Connection strand = testSignal.connect(ExecutorScheme::STRAND, [&stranded](Buffer b) { stranded += *b; }, 1);
+    auto pooledSlot = [&pooled](Buffer b) { pooled += *b; };
+    ASSERT_THROW(testSignal.connect(ExecutorScheme::THREAD_POOLED, pooledSlot), std::logic_error);
+    for (uint32_t i = 0; i < nEmissions; i++) {
+        ASSERT_TRUE(testSignal.emitSignal(Buffer(new uint32_t(1))));
+    }
+    strand.disconnect();
+    ASSERT_EQ(nEmissions, stranded);
+    testSignal.connect(ExecutorScheme::THREAD_POOLED, pooledSlot);
+    for (uint32_t i = 0; i < nEmissions; i++) {
+        testSignal.emitSignal(Buffer(new uint32_t(1)));
+    }
+    while (pooled != nEmissions) std::this_thread::yield();
+    testSignal.disconnectAllSlots();
+    
+    StaticSignal<ExecutorScheme::STRAND, Buffer> staticSignal;
+    staticSignal.connectSlot([&stranded](Buffer b) { stranded += *b; });
+    ASSERT_THROW(staticSignal.connectSlot([&stranded](Buffer b) { stranded += *b; }), std::logic_error);
+    for (uint32_t i = 0; i < nEmissions; i++) {
+        staticSignal.emitSignal(Buffer(new uint32_t(1)));
+    }
+    staticSignal.disconnectAllSlots();
+    ASSERT_EQ(2*nEmissions, stranded);
+    
+    BSignals::details::WheeledThreadPool::global().run([&pooled](Buffer b) { pooled += *b; }, Buffer(new uint32_t(1)));
+    while (pooled != nEmissions + 1) std::this_thread::yield();
+    
+    SafeQueue<Buffer> queue;
+    queue.enqueue(Buffer(new uint32_t(3)));
+    queue.emplace(new uint32_t(4));
+    std::vector<Buffer> drained = queue.dequeueAll();
+    ASSERT_EQ(2u, drained.size());
+    ASSERT_EQ(7u, *drained[0] + *drained[1]);
+}
+
+TEST_F(SignalTest, FanOutReleasesSharedPayload) {
+    const uint32_t nSlots = 50;
+    atomic<uint32_t> completed{0};
+    Signal<std::shared_ptr<int>> testSignal;
+    testSignal.connectSlot(ExecutorScheme::SYNCHRONOUS, [&completed](const std::shared_ptr<int> &) { completed++; });
+    for (uint32_t i = 0; i < nSlots; i++) {
+        testSignal.connectSlot(i%2 ? ExecutorScheme::STRAND : ExecutorScheme::THREAD_POOLED, 
+            [&completed](const std::shared_ptr<int> &) { completed++; });
+    }
+    
+    auto value = std::make_shared<int>(1);
+    for (uint32_t i = 0; i < 100; i++) {
+        testSignal.emitSignal(value);
+    }
+    while (completed != 100*(nSlots + 1)) std::this_thread::yield();
+    //the last task to finish returns the payload, which may lag the slot itself
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (value.use_count() != 1 && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+    ASSERT_EQ(1, value.use_count());
+    testSignal.disconnectAllSlots();
+}
+
 class TestClass {
 public:
 
@@ -229,6 +386,561 @@ public:
     Signal<uint32_t> internalSignal;
 };
 
+TEST_F(SignalTest, BatchEmission) {
+    const uint32_t nEmissions = 1000;
+    std::vector<std::tuple<uint32_t, std::string>> batch;
+    for (uint32_t i = 0; i < nEmissions; i++) {
+        batch.emplace_back(i, std::to_string(i));
+    }
+    
+    Signal<uint32_t, std::string> testSignal;
+    std::vector<uint32_t> syncOrder, strandOrder;
+    atomic<uint32_t> strandCompleted{0};
+    atomic<uint32_t> pooledCompleted{0};
+    testSignal.connectSlot(ExecutorScheme::SYNCHRONOUS, [&syncOrder](uint32_t i, const std::string &s) {
+        if (std::to_string(i) == s) syncOrder.push_back(i);
+    });
+    testSignal.connectSlot(ExecutorScheme::STRAND, [&strandOrder, &strandCompleted](uint32_t i, const std::string &s) {
+        if (std::to_string(i) == s) strandOrder.push_back(i);
+        strandCompleted++;
+    });
+    testSignal.connectSlot(ExecutorScheme::THREAD_POOLED, [&pooledCompleted](uint32_t, const std::string &) {
+        pooledCompleted++;
+    });
+    
+    testSignal.emitSignalBatch(batch.begin(), batch.end());
+    testSignal.emitSignalBatch(batch.data(), batch.size());
+    while (strandCompleted != 2*nEmissions || pooledCompleted != 2*nEmissions) std::this_thread::yield();
+    
+    ASSERT_EQ(2*nEmissions, syncOrder.size());
+    ASSERT_EQ(syncOrder, strandOrder);
+    for (uint32_t i = 0; i < 2*nEmissions; i++) {
+        ASSERT_EQ(i%nEmissions, strandOrder[i]);
+    }
+    testSignal.disconnectAllSlots();
+}
+
+TEST_F(SignalTest, ConnectionHandles) {
+    atomic<uint32_t> calls{0};
+    Connection outlived;
+    {
+        Signal<uint32_t> testSignal;
+        {
+            ScopedConnection scoped = testSignal.connect(ExecutorScheme::SYNCHRONOUS, [&calls](uint32_t) { calls++; });
+            testSignal.emitSignal(1);
+            ASSERT_EQ(1u, calls);
+            {
+                ConnectionBlocker blocker(scoped);
+                ConnectionBlocker nested(scoped);
+                testSignal.emitSignal(1);
+            }
+            ASSERT_EQ(1u, calls);
+            testSignal.emitSignal(1);
+            ASSERT_EQ(2u, calls);
+        }
+        testSignal.emitSignal(1);
+        ASSERT_EQ(2u, calls);
+        
+        //disconnect half of many slots, the tombstones are skipped and compacted away
+        std::vector<Connection> connections;
+        for (uint32_t i = 0; i < 100; i++) {
+            connections.push_back(testSignal.connect(ExecutorScheme::SYNCHRONOUS, [&calls](uint32_t) { calls++; }));
+        }
+        for (uint32_t i = 0; i < 100; i += 2) {
+            connections[i].disconnect();
+            ASSERT_FALSE(connections[i].connected());
+        }
+        calls = 0;
+        testSignal.emitSignal(1);
+        ASSERT_EQ(50u, calls);
+        testSignal.disconnectSlot(connections[1].id());
+        ASSERT_FALSE(connections[1].connected());
+        calls = 0;
+        testSignal.emitSignal(1);
+        ASSERT_EQ(49u, calls);
+        
+        outlived = testSignal.connect(ExecutorScheme::STRAND, [&calls](uint32_t) { calls++; });
+        ASSERT_TRUE(outlived.connected());
+    }
+    ASSERT_FALSE(outlived.connected());
+    ASSERT_EQ(-1, outlived.id());
+    outlived.disconnect();
+}
+
+template <typename S>
+void disconnectWhileAsyncSlotRuns(S &testSignal, std::function<int(std::function<void(uint32_t)>)> connect) {
+    atomic<bool> started{false};
+    atomic<bool> go{false};
+    atomic<bool> finished{false};
+    int quick = connect([](uint32_t) {});
+    int other = connect([](uint32_t) {});
+    int blocking = connect([&](uint32_t) {
+        started = true;
+        while (!go) std::this_thread::yield();
+        testSignal.disconnectSlot(other);
+        finished = true;
+    });
+    testSignal.emitSignal(1);
+    while (!started) std::this_thread::yield();
+
+    //only the disconnected slot's own threads are waited for
+    testSignal.disconnectSlot(quick);
+
+    //the running slot disconnects another one while it is being disconnected
+    thread releaser([&go]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        go = true;
+    });
+    testSignal.disconnectSlot(blocking);
+    ASSERT_TRUE(finished);
+    releaser.join();
+}
+
+TEST_F(SignalTest, AsynchronousDisconnect) {
+    Signal<uint32_t> testSignal;
+    disconnectWhileAsyncSlotRuns(testSignal, [&testSignal](std::function<void(uint32_t)> f) {
+        return testSignal.connectSlot(ExecutorScheme::ASYNCHRONOUS, std::move(f));
+    });
+    StaticSignal<ExecutorScheme::ASYNCHRONOUS, uint32_t> staticSignal;
+    disconnectWhileAsyncSlotRuns(staticSignal, [&staticSignal](std::function<void(uint32_t)> f) {
+        return staticSignal.connectSlot(std::move(f));
+    });
+}
+
+TEST_F(SignalTest, SlotPriorities) {
+    Signal<uint32_t> testSignal;
+    std::vector<uint32_t> order;
+    const std::vector<int32_t> priorities = {0, 10, -5, 10, 3};
+    for (uint32_t i = 0; i < priorities.size(); i++) {
+        testSignal.connectSlot(ExecutorScheme::SYNCHRONOUS, [&order, i](uint32_t) { order.push_back(i); }, priorities[i]);
+    }
+    testSignal.emitSignal(1);
+    ASSERT_EQ((std::vector<uint32_t>{1, 3, 4, 0, 2}), order);
+    testSignal.disconnectAllSlots();
+    
+    //a high priority queued slot starts before a slow synchronous slot returns
+    atomic<bool> started{false};
+    atomic<bool> overlapped{false};
+    testSignal.connectSlot(ExecutorScheme::SYNCHRONOUS, [&started, &overlapped](uint32_t) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!started && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+        overlapped = started.load();
+    });
+    testSignal.connectSlot(ExecutorScheme::STRAND, [&started](uint32_t) { started = true; }, 1);
+    testSignal.emitSignal(1);
+    ASSERT_TRUE(overlapped);
+    testSignal.disconnectAllSlots();
+}
+
+TEST_F(SignalTest, BoundedStrandOverflow) {
+    const uint32_t capacity = 4;
+    const uint32_t nEmissions = 10;
+    //the slot holds up the strand on emission 0 until released, so the
+    //remaining emissions meet a ring with room for only capacity of them
+    //A single producer strand must behave the same through its SPSC ring,
+    //which takes every policy but DROP_OLDEST
+    auto overflow = [capacity, nEmissions](BSignals::OverflowPolicy policy, bool singleProducer, vector<bool> &results){
+        Signal<uint32_t> testSignal;
+        vector<uint32_t> received;
+        atomic<bool> started{false};
+        atomic<bool> released{false};
+        testSignal.connectSlot(ExecutorScheme::STRAND, [&](uint32_t x) {
+            started = true;
+            while (!released) std::this_thread::yield();
+            received.push_back(x);
+        }, BSignals::QueueLimit{capacity, policy, singleProducer});
+        
+        atomic<uint32_t> emitted{0};
+        thread emitter([&](){
+            for (uint32_t i = 0; i < nEmissions; i++) {
+                results.push_back(testSignal.emitSignal(i));
+                emitted++;
+                while (!started) std::this_thread::yield();
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        uint32_t beforeRelease = emitted;
+        released = true;
+        emitter.join();
+        testSignal.disconnectAllSlots();
+        return std::make_pair(beforeRelease, received);
+    };
+    
+    for (bool singleProducer : {false, true}){
+        vector<bool> results;
+        auto blocked = overflow(BSignals::OverflowPolicy::BLOCK, singleProducer, results);
+        ASSERT_EQ(1 + capacity, blocked.first);
+        ASSERT_EQ((vector<uint32_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), blocked.second);
+        
+        results.clear();
+        auto newest = overflow(BSignals::OverflowPolicy::DROP_NEWEST, singleProducer, results);
+        ASSERT_EQ(nEmissions, newest.first);
+        ASSERT_EQ((vector<uint32_t>{0, 1, 2, 3, 4}), newest.second);
+        ASSERT_EQ(vector<bool>(nEmissions, true), results);
+        
+        if (!singleProducer){
+            results.clear();
+            auto oldest = overflow(BSignals::OverflowPolicy::DROP_OLDEST, singleProducer, results);
+            ASSERT_EQ((vector<uint32_t>{0, 6, 7, 8, 9}), oldest.second);
+            ASSERT_EQ(vector<bool>(nEmissions, true), results);
+        }
+        
+        results.clear();
+        auto failed = overflow(BSignals::OverflowPolicy::FAIL_FAST, singleProducer, results);
+        ASSERT_EQ((vector<uint32_t>{0, 1, 2, 3, 4}), failed.second);
+        ASSERT_EQ((vector<bool>{true, true, true, true, true, false, false, false, false, false}), results);
+    }
+}
+
+TEST_F(SignalTest, SingleProducerStrandLimits) {
+    //only a bounded strand has an SPSC ring, and DROP_OLDEST needs the
+    //emitter to dequeue, so neither is accepted with a single producer
+    Signal<uint32_t> testSignal;
+    atomic<uint32_t> received{0};
+    auto slot = [&received](uint32_t x) { received += x; };
+    ASSERT_THROW(testSignal.connectSlot(ExecutorScheme::STRAND, slot, 
+        BSignals::QueueLimit{0, BSignals::OverflowPolicy::BLOCK, true}), std::invalid_argument);
+    ASSERT_THROW(testSignal.connect(ExecutorScheme::STRAND, slot, 
+        BSignals::QueueLimit{4, BSignals::OverflowPolicy::DROP_OLDEST, true}), std::invalid_argument);
+    
+    //a rejected connection leaves no slot behind
+    testSignal.emitSignal(1);
+    ASSERT_EQ(0u, received);
+    
+    testSignal.connectSlot(ExecutorScheme::STRAND, slot, BSignals::QueueLimit{4, BSignals::OverflowPolicy::BLOCK, true});
+    testSignal.connectSlot(ExecutorScheme::STRAND, slot, BSignals::QueueLimit{4, BSignals::OverflowPolicy::DROP_OLDEST});
+    testSignal.emitSignal(1);
+    testSignal.disconnectAllSlots();
+    ASSERT_EQ(2u, received);
+}
+
+TEST_F(SignalTest, QueueStatistics) {
+    const uint32_t nEmissions = 10;
+    for (uint32_t capacity : {0u, 16u}){
+        Signal<uint32_t> testSignal;
+        atomic<bool> started{false};
+        atomic<bool> released{false};
+        atomic<uint32_t> completed{0};
+        int id = testSignal.connectSlot(ExecutorScheme::STRAND, [&](uint32_t) {
+            started = true;
+            while (!released) std::this_thread::yield();
+            completed++;
+        }, BSignals::QueueLimit{capacity, BSignals::OverflowPolicy::BLOCK});
+        
+        //the first emission holds up the strand, the rest back up behind it
+        testSignal.emitSignal(0);
+        while (!started) std::this_thread::yield();
+        for (uint32_t i = 1; i < nEmissions; i++) testSignal.emitSignal(i);
+        BSignals::QueueStats stats = testSignal.queueStats().at(id);
+        //released before asserting so that a failure can't leave the strand stuck
+        released = true;
+        ASSERT_EQ(nEmissions, stats.enqueued);
+        ASSERT_EQ(stats.enqueued - stats.dequeued, stats.depth);
+        ASSERT_GE(stats.depth, nEmissions - 1);
+        
+        while (completed != nEmissions) std::this_thread::yield();
+        stats = testSignal.queueStats().at(id);
+        ASSERT_EQ(nEmissions, stats.dequeued);
+        ASSERT_EQ(0u, stats.depth);
+        ASSERT_GE(stats.highWatermark, nEmissions - 1);
+        testSignal.disconnectAllSlots();
+        ASSERT_TRUE(testSignal.queueStats().empty());
+    }
+    
+    auto poolEnqueued = [](){
+        uint64_t enqueued = 0;
+        for (auto &stats : Signal<uint32_t>::threadPoolStats()) enqueued += stats.enqueued;
+        return enqueued;
+    };
+    Signal<uint32_t> pooledSignal;
+    atomic<uint32_t> completed{0};
+    pooledSignal.connectSlot(ExecutorScheme::THREAD_POOLED, [&completed](uint32_t) { completed++; });
+    uint64_t before = poolEnqueued();
+    for (uint32_t i = 0; i < nEmissions; i++) pooledSignal.emitSignal(i);
+    while (completed != nEmissions) std::this_thread::yield();
+    ASSERT_EQ(before + nEmissions, poolEnqueued());
+    pooledSignal.disconnectAllSlots();
+    
+    //the watermark is the deepest the queue got, however it was drained
+    TaskQueue tasks;
+    for (uint32_t i = 0; i < nEmissions; i++) tasks.enqueue(BSignals::details::makeTask([](){}));
+    TaskNode *task = nullptr;
+    for (uint32_t i = 0; i < nEmissions/2; i++){
+        ASSERT_TRUE(tasks.dequeue(task));
+        task->run();
+    }
+    tasks.enqueue(BSignals::details::makeTask([](){}));
+    while (tasks.dequeue(task)) task->run();
+    BSignals::QueueStats stats = tasks.stats();
+    ASSERT_EQ(0u, stats.depth);
+    ASSERT_EQ((uint64_t)nEmissions, stats.highWatermark);
+}
+
+TEST_F(SignalTest, ThreadPoolSize) {
+    Signal<uint32_t> pooledSignal;
+    atomic<uint32_t> completed{0};
+    pooledSignal.connectSlot(ExecutorScheme::THREAD_POOLED, [&completed](uint32_t) { completed++; });
+    uint32_t poolSize = BSignals::threadPoolSize();
+    cout << "Thread pool size: " << poolSize << endl;
+    ASSERT_GE(poolSize, 1u);
+    ASSERT_EQ(poolSize, Signal<uint32_t>::threadPoolStats().size());
+    
+    //the pool is running, so its size is fixed
+    ASSERT_FALSE(BSignals::configureThreadPool(poolSize + 1));
+    ASSERT_FALSE(BSignals::configureThreadPool(1, poolSize + 1));
+    //and these bounds are never valid
+    ASSERT_FALSE(BSignals::configureThreadPool(0, 4));
+    ASSERT_FALSE(BSignals::configureThreadPool(4, 2));
+    ASSERT_EQ(poolSize, BSignals::threadPoolSize());
+    
+    //every emission is run whichever way the spokes are picked
+    for (auto selection : {BSignals::SpokeSelection::ROUND_ROBIN, BSignals::SpokeSelection::LEAST_LOADED_OF_TWO}) {
+        BSignals::setThreadPoolSelection(selection);
+        completed = 0;
+        for (uint32_t i = 0; i < 2*poolSize; i++) pooledSignal.emitSignal(i);
+        while (completed != 2*poolSize) std::this_thread::yield();
+    }
+    pooledSignal.disconnectAllSlots();
+}
+
+TEST_F(SignalTest, LocalThreadPools) {
+    ThreadPool routing(2);
+    ThreadPool analytics(1, BSignals::SpokeSelection::ROUND_ROBIN);
+    ASSERT_EQ(2u, routing.size());
+    ASSERT_EQ(1u, analytics.size());
+
+    Signal<uint32_t> orders;
+    Signal<uint32_t> reports;
+    atomic<bool> released{false};
+    atomic<uint32_t> reported{0};
+    atomic<uint32_t> routed{0};
+    std::mutex idLock;
+    std::set<std::thread::id> routingThreads;
+    reports.connectSlot(analytics, [&released, &reported](uint32_t) {
+        while (!released) std::this_thread::yield();
+        reported++;
+    });
+    orders.connectSlot(routing, [&routed, &idLock, &routingThreads](uint32_t) {
+        std::lock_guard<std::mutex> lock(idLock);
+        routingThreads.insert(std::this_thread::get_id());
+        routed++;
+    });
+    ASSERT_EQ(2u, routing.stats().size());
+    ASSERT_EQ(1u, analytics.stats().size());
+
+    //the analytics thread is held up, order routing carries on regardless
+    for (uint32_t i = 0; i < 10; i++) reports.emitSignal(i);
+    for (uint32_t i = 0; i < 1000; i++) orders.emitSignal(i);
+    while (routed != 1000) std::this_thread::yield();
+    uint32_t reportedWhileHeld = reported;
+    released = true;
+    ASSERT_EQ(0u, reportedWhileHeld);
+    ASSERT_LE(routingThreads.size(), 2u);
+    while (reported != 10) std::this_thread::yield();
+
+    //every emission went through the pool's own spokes
+    uint64_t enqueued = 0;
+    for (auto &stats : routing.stats()) enqueued += stats.enqueued;
+    ASSERT_EQ(1000u, enqueued);
+    orders.disconnectAllSlots();
+    reports.disconnectAllSlots();
+}
+
+TEST_F(SignalTest, DestroyWithQueuedPoolWork) {
+    ThreadPool pool(1);
+    atomic<bool> released{false};
+    atomic<uint32_t> calls{0};
+    auto emitHeld = [&released, &calls](std::function<void(uint32_t)> emit) {
+        released = false;
+        calls = 0;
+        thread releaser([&released]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            released = true;
+        });
+        for (uint32_t i = 0; i < 100; i++) emit(i);
+        return releaser;
+    };
+    auto slot = [&released, &calls](uint32_t) {
+        while (!released) std::this_thread::yield();
+        calls++;
+    };
+
+    //destruction waits for the queued emissions, which still see their slot
+    thread releaser;
+    {
+        Signal<uint32_t> testSignal;
+        testSignal.connectSlot(pool, slot);
+        releaser = emitHeld([&testSignal](uint32_t i) { testSignal.emitSignal(i); });
+    }
+    ASSERT_EQ(100u, calls);
+    releaser.join();
+    {
+        StaticSignal<ExecutorScheme::THREAD_POOLED, uint32_t> testSignal;
+        testSignal.connectSlot(slot);
+        releaser = emitHeld([&testSignal](uint32_t i) { testSignal.emitSignal(i); });
+    }
+    ASSERT_EQ(100u, calls);
+    releaser.join();
+
+    //emissions still queued when the pool stops are discarded, which releases
+    //them from their slot too
+    {
+        Signal<uint32_t> testSignal;
+        std::shared_future<void> drained;
+        {
+            ThreadPool stopping(1);
+            int id = testSignal.connectSlot(stopping, slot);
+            releaser = emitHeld([&testSignal](uint32_t i) { testSignal.emitSignal(i); });
+            drained = testSignal.disconnectSlotAsync(id);
+        }
+        ASSERT_EQ(std::future_status::ready, drained.wait_for(std::chrono::seconds(0)));
+        releaser.join();
+    }
+}
+
+TEST_F(SignalTest, ElasticThreadPool) {
+    ThreadPool pool(1, 4, std::chrono::milliseconds(50));
+    ASSERT_EQ(1u, pool.size());
+    //not started until a slot is connected
+    ASSERT_TRUE(pool.stats().empty());
+    ASSERT_EQ(1u, ThreadPool(0, 4).size());
+
+    auto waitFor = [](std::function<bool()> condition) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!condition() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return condition();
+    };
+
+    Signal<uint32_t> signal;
+    atomic<bool> released{false};
+    atomic<uint32_t> completed{0};
+    signal.connectSlot(pool, [&released, &completed](uint32_t) {
+        while (!released) std::this_thread::sleep_for(std::chrono::microseconds(100));
+        completed++;
+    });
+
+    //every thread is kept busy with work queued behind it, so the pool grows
+    for (uint32_t i = 0; i < 8; i++) signal.emitSignal(i);
+    bool grown = waitFor([&pool]() { return pool.size() == 4; });
+    released = true;
+    ASSERT_TRUE(grown);
+    ASSERT_EQ(4u, pool.stats().size());
+    ASSERT_TRUE(waitFor([&completed]() { return completed == 8; }));
+
+    //and shrinks back once its threads are left idle
+    ASSERT_TRUE(waitFor([&pool]() { return pool.size() == 1; }));
+    completed = 0;
+    signal.emitSignal(0);
+    ASSERT_TRUE(waitFor([&completed]() { return completed == 1; }));
+    signal.disconnectAllSlots();
+}
+
+TEST_F(SignalTest, ElasticThreadPoolBounds) {
+    const auto idleTimeout = std::chrono::milliseconds(20);
+    ThreadPool pool(2, 5, idleTimeout);
+    Signal<uint32_t> signal;
+    atomic<bool> released{false};
+    atomic<uint32_t> completed{0};
+    atomic<uint32_t> largest{0};
+    signal.connectSlot(pool, [&](uint32_t) {
+        uint32_t size = pool.size();
+        uint32_t seen = largest;
+        while (size > seen && !largest.compare_exchange_weak(seen, size)) {}
+        while (!released) std::this_thread::sleep_for(std::chrono::microseconds(100));
+        completed++;
+    });
+    ASSERT_EQ(2u, pool.size());
+
+    //far more blocked work than threads, the pool grows to its maximum only
+    const uint32_t nEmissions = 64;
+    for (uint32_t i = 0; i < nEmissions; i++) signal.emitSignal(i);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (pool.size() < 5 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    uint32_t grown = pool.size();
+    released = true;
+    while (completed != nEmissions) std::this_thread::yield();
+    ASSERT_EQ(5u, grown);
+    ASSERT_LE(largest, 5u);
+
+    //idle threads retire down to the minimum and no further
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (pool.size() > 2 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(2u, pool.size());
+    std::this_thread::sleep_for(idleTimeout*10);
+    ASSERT_EQ(2u, pool.size());
+    signal.disconnectAllSlots();
+}
+
+TEST_F(SignalTest, WorkStealingDeque) {
+    //the owner pushes past the initial capacity and pops while thieves steal,
+    //every element must be taken exactly once
+    const uint32_t nItems = 100000;
+    const uint32_t nThieves = 3;
+    WorkStealingDeque<uint32_t*> deque(4);
+    vector<uint32_t> items(nItems);
+    vector<atomic<uint32_t>> taken(nItems);
+    atomic<bool> done{false};
+    vector<thread> thieves;
+    for (uint32_t t = 0; t < nThieves; t++) {
+        thieves.emplace_back([&]() {
+            uint32_t *item;
+            while (!done || !deque.empty()) {
+                if (deque.steal(item)) taken[item - items.data()]++;
+            }
+        });
+    }
+    uint32_t *item;
+    for (uint32_t i = 0; i < nItems; i++) {
+        deque.push(&items[i]);
+        if (i % 3 == 0 && deque.pop(item)) taken[item - items.data()]++;
+    }
+    while (deque.pop(item)) taken[item - items.data()]++;
+    done = true;
+    for (auto &t : thieves) t.join();
+    for (uint32_t i = 0; i < nItems; i++) ASSERT_EQ(1u, taken[i].load());
+}
+
+TEST_F(SignalTest, TimedBlockingDequeue) {
+    const auto timeout = std::chrono::milliseconds(20);
+    MPSCQueue<uint32_t> queue;
+    uint32_t x = 0;
+    
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_FALSE(queue.blockingDequeueFor(x, timeout));
+    auto waited = std::chrono::steady_clock::now() - start;
+    cout << "Timeout overshoot: " << std::chrono::duration_cast<std::chrono::microseconds>(waited - timeout).count() << "us" << endl;
+    ASSERT_GE(waited, timeout);
+    
+    //a deadline in the past still takes what is already queued
+    queue.enqueue(1);
+    ASSERT_TRUE(queue.blockingDequeueUntil(x, start));
+    ASSERT_EQ(1u, x);
+    
+    thread producer([&queue, timeout](){
+        std::this_thread::sleep_for(timeout);
+        queue.enqueue(2);
+    });
+    start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(queue.blockingDequeueFor(x, std::chrono::seconds(10)));
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    ASSERT_EQ(2u, x);
+    producer.join();
+    
+    TaskQueue tasks;
+    TaskNode *task = nullptr;
+    ASSERT_FALSE(tasks.blockingDequeueFor(task, timeout));
+    tasks.enqueue(BSignals::details::makeTask([&x](){ x = 3; }));
+    ASSERT_TRUE(tasks.blockingDequeueFor(task, timeout));
+    task->run();
+    ASSERT_EQ(3u, x);
+}
+
 TEST_F(SignalTest, MemberFunction) {
     TestClass tc;
     Signal<int> testSignal;
@@ -356,6 +1068,99 @@ TEST_P(SignalTestParametrized, IntenseUsage) {
 }
 
 
+TEST_P(SignalTestParametrized, IntenseBatchUsage) {
+    auto tupleParams = GetParam();
+    SignalTestParameters params = {::testing::get<0>(tupleParams), ::testing::get<1>(tupleParams), ::testing::get<2>(tupleParams), ::testing::get<3>(tupleParams)};
+    BasicTimer bt, bt2;
+
+    cout << "Intense batch usage test for signal type: ";
+    switch (params.scheme) {
+        case(ExecutorScheme::ASYNCHRONOUS):
+            cout << "Asynchronous";
+            break;
+        case(ExecutorScheme::STRAND):
+            cout << "Strand";
+            break;
+        case(ExecutorScheme::SYNCHRONOUS):
+            cout << "Synchronous";
+            break;
+        case (ExecutorScheme::THREAD_POOLED):
+            cout << "Thread Pooled";
+            break;
+    }
+    cout << endl;
+    uint32_t counter = 0;
+    atomic<uint32_t> completedFunctions;
+    completedFunctions = 0;
+    cout << "Emissions: " << params.nEmissions << ", Connections: " << params.nConnections <<
+            ", Operations: " << params.nOperations << endl;
+
+    typedef uint32_t sigType;
+    auto func = ([&params, &completedFunctions](sigType x) {
+        volatile sigType v = x;
+        for (uint32_t i = 0; i < params.nOperations; i++) {
+            v+=x;
+        }
+        completedFunctions++;
+    });
+
+    bt.start();
+    for (uint32_t i = 0; i < 10; i++) {
+        func(sigType{i});
+    }
+    bt.stop();
+    completedFunctions -= 10;
+    cout << "Function runtime overhead: " << bt.getElapsedNanoseconds() / 10 << "ns" << endl;
+
+    Signal<sigType> signal;
+    cout << "Connecting " << params.nConnections << " functions" << endl;
+    for (uint32_t i = 0; i < params.nConnections; i++) {
+        signal.connectSlot(params.scheme, func);
+    }
+
+    FunctionTimeRegular<> printer([this, &counter, &completedFunctions, &bt, &bt2, &params]() {
+        cout << "Total elements emitted: " << counter << " / " << params.nEmissions << fixed << endl;
+        cout << "Emission rate: " << (double) counter / bt.getElapsedMilliseconds() << fixed << "m/ms" << endl;
+        cout << "Total elements processed: " << completedFunctions << " / " << params.nEmissions * params.nConnections << fixed << endl;
+        cout << "Operation rate: " << (double) completedFunctions * params.nOperations / bt2.getElapsedNanoseconds() << "m/ns" << endl;
+        return (bt2.getElapsedSeconds() < 6000);
+    }, std::chrono::milliseconds(500));
+
+    FunctionTimeRegular<> checkFinished([this, &params, &completedFunctions]() {
+        return (completedFunctions != params.nEmissions * params.nConnections);
+    }, std::chrono::milliseconds(1));
+
+    cout << "Starting emission thread: " << endl;
+    
+    thread emitter([&params, &signal, &bt, &bt2, &counter]() {
+        const uint32_t batchSize = 256;
+        std::vector<sigType> batch(batchSize, 1);
+        bt2.start();
+        bt.start();
+        for (uint32_t i=0; i<params.nEmissions; i+=batchSize) {
+            uint32_t n = std::min(batchSize, params.nEmissions - i);
+            signal.emitSignalBatch(batch.data(), n);
+            counter+=n;
+        }
+        bt.stop();
+    });
+    cout << "Emission thread spawned" << endl;
+    cout.precision(std::numeric_limits<double>::max_digits10);
+    emitter.join();
+    cout << "Emission completed" << endl;
+    checkFinished.join();
+    bt2.stop();
+    printer.stopAndJoin();
+    cout << "Processing completed" << endl;
+    cout << "Emission rate: " << (double) counter / bt.getElapsedMilliseconds() << fixed << "m/ms" << endl;
+    cout << "Time to emit: " << bt.getElapsedMilliseconds() << "ms" << endl;
+    cout << "Average emit time (overall): " << (double) bt.getElapsedNanoseconds() / (params.nEmissions) << "ns" << endl;
+    cout << "Average emit time (per connection): " << (double) bt.getElapsedNanoseconds() / (params.nEmissions*params.nConnections) << "ns" << endl;
+    cout << "Time to emit+process: " << bt2.getElapsedMilliseconds() << "ms" << endl;
+    cout << "Average emit+process time (overall): " << (double) bt2.getElapsedNanoseconds() / params.nEmissions << "ns" << endl;
+    cout << "Average emit+process time (per connection): " << (double) bt2.getElapsedNanoseconds() / (params.nEmissions*params.nConnections) << "ns" << endl;
+}
+
 TEST_P(SignalTestParametrized, LengthyUsage) {
     auto tupleParams = GetParam();
     SignalTestParameters params = {::testing::get<0>(tupleParams), ::testing::get<1>(tupleParams), ::testing::get<2>(tupleParams), ::testing::get<3>(tupleParams)};